@@ -0,0 +1,37 @@
+// Copyright (c) 2025 SolverX Corporation
+// This file is part of MIE OpenCascade WebAssembly Bindings.
+//
+// This library is free software; you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License version 2.1 as published
+// by the Free Software Foundation.
+
+#include "async_task.hpp"
+
+#ifdef __EMSCRIPTEN_PTHREADS__
+#include <emscripten/proxying.h>
+#include <emscripten/threading.h>
+
+#include <utility>
+
+void runOnMainRuntimeThread(std::function<void()> job) {
+    if (emscripten_is_main_runtime_thread()) {
+        job();
+        return;
+    }
+
+    static emscripten::ProxyingQueue queue;
+    queue.proxyAsync(emscripten_main_runtime_thread_id(), std::move(job));
+}
+
+void runOnMainRuntimeThreadSync(const std::function<void()>& job) {
+    if (emscripten_is_main_runtime_thread()) {
+        job();
+        return;
+    }
+
+    // unlike other queues, the system queue is processed while the main thread waits on a futex
+    emscripten_proxy_sync(emscripten_proxy_get_system_queue(), emscripten_main_runtime_thread_id(), [](void* arg) {
+        (*static_cast<const std::function<void()>*>(arg))();
+    }, const_cast<std::function<void()>*>(&job));
+}
+#endif
@@ -7,11 +7,21 @@
 
 #pragma once
 
-#include "model_context.hpp"
+#include "task_progress.hpp"
 
+#include <emscripten/val.h>
+
+#include <functional>
 #include <mutex>
+#include <optional>
 
 #ifdef __EMSCRIPTEN_PTHREADS__
+// runs the job on the main runtime thread, where JS objects can be touched
+void runOnMainRuntimeThread(std::function<void()> job);
+// runs the job on the main runtime thread and waits for it to return. the main thread also runs it
+// while blocked on a lock, so a worker of a blocking call made from the main thread can use it.
+void runOnMainRuntimeThreadSync(const std::function<void()>& job);
+
 template<typename T>
 class AsyncTask {
 public:
@@ -21,10 +31,13 @@ private:
     std::mutex mutex;
     bool completed;
     std::optional<T> value;
+    Handle(TaskProgress) progress;
+    bool promised;
+    std::optional<emscripten::val> resolvePromise; // only touched on the main runtime thread
 
 public:
     AsyncTask()
-        : completed(false), value(std::nullopt)
+        : completed(false), value(std::nullopt), progress(new TaskProgress()), promised(false)
     { }
 
     bool isCompleted() {
@@ -38,9 +51,72 @@ public:
     }
 
     void setValue(std::optional<T>&& newValue) {
+        bool resolve;
+        bool hasValue;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            value = std::move(newValue);
+            completed = true;
+            if (!progress->isCancelled()) {
+                progress->setPhase(TaskPhase::Completed);
+            }
+            resolve = promised;
+            hasValue = value.has_value();
+        }
+
+        if (resolve) {
+            // NOTE: the task must be kept alive until the promise is settled
+            runOnMainRuntimeThread([this, hasValue]() {
+                (*resolvePromise)(hasValue);
+                resolvePromise.reset();
+            });
+        }
+    }
+
+    // promise resolving with whether a value is available once the task completes.
+    // must be called on the main runtime thread before the work is started.
+    emscripten::val createPromise() {
+        emscripten::val resolvers = emscripten::val::global("Promise").call<emscripten::val>("withResolvers");
+        resolvePromise = resolvers["resolve"];
+
         std::lock_guard<std::mutex> lock(mutex);
-        value = std::move(newValue);
-        completed = true;
+        promised = true;
+        return resolvers["promise"];
+    }
+
+    // running work stops at its next progress check and completes the task without a value
+    void cancel() {
+        progress->cancel();
+    }
+
+    bool isCancelled() const {
+        return progress->isCancelled();
+    }
+
+    TaskPhase getPhase() const {
+        return progress->getPhase();
+    }
+
+    // fraction of the current phase in [0, 1]
+    float getProgress() const {
+        return progress->getFraction();
+    }
+
+    uint32_t getItemsProcessed() const {
+        return progress->getItemsProcessed();
+    }
+
+    uint32_t getItemsTotal() const {
+        return progress->getItemsTotal();
+    }
+
+    const Handle(TaskProgress)& getProgressIndicator() const {
+        return progress;
+    }
+
+    // for work which was started before the task was handed over
+    void setProgressIndicator(const Handle(TaskProgress)& newProgress) {
+        progress = newProgress;
     }
 };
 
@@ -48,7 +124,13 @@ public:
     emscripten::class_<TaskType>(#TaskType) \
         .constructor<>() \
         .function("isCompleted", &TaskType::isCompleted) \
-        .function("takeValue", &TaskType::takeValue, emscripten::return_value_policy::take_ownership());\
+        .function("takeValue", &TaskType::takeValue, emscripten::return_value_policy::take_ownership()) \
+        .function("cancel", &TaskType::cancel) \
+        .function("isCancelled", &TaskType::isCancelled) \
+        .function("getPhase", &TaskType::getPhase) \
+        .function("getProgress", &TaskType::getProgress) \
+        .function("getItemsProcessed", &TaskType::getItemsProcessed) \
+        .function("getItemsTotal", &TaskType::getItemsTotal);\
     \
     emscripten::register_optional<typename TaskType::valueType>();
 #endif
@@ -0,0 +1,171 @@
+// Copyright (c) 2025 SolverX Corporation
+// This file is part of MIE OpenCascade WebAssembly Bindings.
+//
+// This library is free software; you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License version 2.1 as published
+// by the Free Software Foundation.
+
+#include "bvh.hpp"
+
+#include <limits>
+
+namespace {
+
+constexpr size_t BIN_COUNT = 12;
+constexpr float TRAVERSAL_COST = 1.0f; // relative to one primitive test
+
+struct BuildRange {
+    uint32_t nodeIndex;
+    uint32_t begin;
+    uint32_t end;
+    uint32_t depth;
+};
+
+float surfaceArea(const Bounds& bounds) {
+    if (bounds[0] > bounds[3]) {
+        return 0.0f;
+    }
+    const float dx = bounds[3] - bounds[0];
+    const float dy = bounds[4] - bounds[1];
+    const float dz = bounds[5] - bounds[2];
+    return 2.0f * (dx * dy + dy * dz + dz * dx);
+}
+
+void expand(Bounds& bounds, const Bounds& other) {
+    for (size_t axis = 0; axis < 3; ++axis) {
+        bounds[axis] = std::min(bounds[axis], other[axis]);
+        bounds[axis + 3] = std::max(bounds[axis + 3], other[axis + 3]);
+    }
+}
+
+float centroid(const Bounds& bounds, size_t axis) {
+    return (bounds[axis] + bounds[axis + 3]) * 0.5f;
+}
+
+} // namespace
+
+void Bvh::build(const std::vector<Bounds>& primitiveBounds) {
+    nodes.clear();
+    primitiveIndices.resize(primitiveBounds.size());
+    for (size_t i = 0; i < primitiveIndices.size(); ++i) {
+        primitiveIndices[i] = static_cast<uint32_t>(i);
+    }
+    if (primitiveBounds.empty()) {
+        return;
+    }
+    nodes.reserve(primitiveBounds.size() * 2 - 1);
+    nodes.push_back(Node());
+
+    std::vector<BuildRange> stack = { { 0, 0, static_cast<uint32_t>(primitiveBounds.size()), 0 } };
+    while (!stack.empty()) {
+        const BuildRange range = stack.back();
+        stack.pop_back();
+
+        Bounds nodeBounds = EMPTY_BOUNDS;
+        Bounds centroidBounds = EMPTY_BOUNDS;
+        for (uint32_t i = range.begin; i < range.end; ++i) {
+            const Bounds& bounds = primitiveBounds[primitiveIndices[i]];
+            expand(nodeBounds, bounds);
+            const Bounds centroidPoint = {
+                centroid(bounds, 0), centroid(bounds, 1), centroid(bounds, 2),
+                centroid(bounds, 0), centroid(bounds, 1), centroid(bounds, 2)
+            };
+            expand(centroidBounds, centroidPoint);
+        }
+        Node& node = nodes[range.nodeIndex];
+        std::copy_n(nodeBounds.begin(), 3, node.boundMin.begin());
+        std::copy_n(nodeBounds.begin() + 3, 3, node.boundMax.begin());
+
+        const uint32_t count = range.end - range.begin;
+        auto makeLeaf = [&]() {
+            nodes[range.nodeIndex].firstChildOrPrimitive = range.begin;
+            nodes[range.nodeIndex].primitiveCount = count;
+        };
+        // the depth limit keeps the traversal stack bounded
+        if (count <= 1 || range.depth + 1 >= MAX_DEPTH) {
+            makeLeaf();
+            continue;
+        }
+
+        // binned SAH along each axis of the centroid bounds
+        float bestCost = std::numeric_limits<float>::max();
+        size_t bestAxis = 0;
+        size_t bestSplit = 0;
+        for (size_t axis = 0; axis < 3; ++axis) {
+            const float axisMin = centroidBounds[axis];
+            const float axisExtent = centroidBounds[axis + 3] - axisMin;
+            if (axisExtent <= 0.0f) {
+                continue;
+            }
+            const float binScale = static_cast<float>(BIN_COUNT) / axisExtent;
+
+            std::array<Bounds, BIN_COUNT> binBounds;
+            std::array<uint32_t, BIN_COUNT> binCounts = {};
+            binBounds.fill(EMPTY_BOUNDS);
+            for (uint32_t i = range.begin; i < range.end; ++i) {
+                const Bounds& bounds = primitiveBounds[primitiveIndices[i]];
+                const size_t bin = std::min(BIN_COUNT - 1, static_cast<size_t>((centroid(bounds, axis) - axisMin) * binScale));
+                expand(binBounds[bin], bounds);
+                ++binCounts[bin];
+            }
+
+            // areas and counts left of each split plane
+            std::array<float, BIN_COUNT - 1> leftAreas;
+            std::array<uint32_t, BIN_COUNT - 1> leftCounts;
+            Bounds leftBounds = EMPTY_BOUNDS;
+            uint32_t leftCount = 0;
+            for (size_t split = 0; split < BIN_COUNT - 1; ++split) {
+                expand(leftBounds, binBounds[split]);
+                leftCount += binCounts[split];
+                leftAreas[split] = surfaceArea(leftBounds);
+                leftCounts[split] = leftCount;
+            }
+            Bounds rightBounds = EMPTY_BOUNDS;
+            uint32_t rightCount = 0;
+            for (size_t split = BIN_COUNT - 1; split > 0; --split) {
+                expand(rightBounds, binBounds[split]);
+                rightCount += binCounts[split];
+                if (leftCounts[split - 1] == 0 || rightCount == 0) {
+                    continue;
+                }
+                const float cost = leftAreas[split - 1] * static_cast<float>(leftCounts[split - 1]) + surfaceArea(rightBounds) * static_cast<float>(rightCount);
+                if (cost < bestCost) {
+                    bestCost = cost;
+                    bestAxis = axis;
+                    bestSplit = split;
+                }
+            }
+        }
+
+        if (bestCost == std::numeric_limits<float>::max()) {
+            // coincident centroids can not be separated by planes
+            makeLeaf();
+            continue;
+        }
+        const float nodeArea = surfaceArea(nodeBounds);
+        const float splitCost = nodeArea > 0.0f ? TRAVERSAL_COST + bestCost / nodeArea : TRAVERSAL_COST;
+        if (count <= MAX_LEAF_PRIMITIVES && splitCost >= static_cast<float>(count)) {
+            makeLeaf();
+            continue;
+        }
+
+        const float axisMin = centroidBounds[bestAxis];
+        const float binScale = static_cast<float>(BIN_COUNT) / (centroidBounds[bestAxis + 3] - axisMin);
+        uint32_t* middle = std::partition(
+            primitiveIndices.data() + range.begin,
+            primitiveIndices.data() + range.end,
+            [&](uint32_t primitive) {
+                const size_t bin = std::min(BIN_COUNT - 1, static_cast<size_t>((centroid(primitiveBounds[primitive], bestAxis) - axisMin) * binScale));
+                return bin < bestSplit;
+            });
+        const uint32_t splitIndex = static_cast<uint32_t>(middle - primitiveIndices.data());
+
+        const uint32_t firstChild = static_cast<uint32_t>(nodes.size());
+        nodes[range.nodeIndex].firstChildOrPrimitive = firstChild;
+        nodes[range.nodeIndex].primitiveCount = 0;
+        nodes.push_back(Node());
+        nodes.push_back(Node());
+        stack.push_back({ firstChild, range.begin, splitIndex, range.depth + 1 });
+        stack.push_back({ firstChild + 1, splitIndex, range.end, range.depth + 1 });
+    }
+}
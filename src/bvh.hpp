@@ -0,0 +1,215 @@
+// Copyright (c) 2025 SolverX Corporation
+// This file is part of MIE OpenCascade WebAssembly Bindings.
+//
+// This library is free software; you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License version 2.1 as published
+// by the Free Software Foundation.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+#ifdef __wasm_simd128__
+#include <wasm_simd128.h>
+#endif
+
+#include "model_context.hpp"
+
+// four rays traversed together, stored per component so that each axis loads as one SIMD vector.
+// lanes without a ray are disabled by a negative tMax.
+struct alignas(16) RayPacket {
+    static constexpr size_t SIZE = 4;
+
+    std::array<std::array<float, SIZE>, 3> origin;
+    std::array<std::array<float, SIZE>, 3> direction;
+    std::array<std::array<float, SIZE>, 3> inverseDirection;
+
+    void setRay(size_t lane, const std::array<float, 3>& rayOrigin, const std::array<float, 3>& rayDirection) {
+        for (size_t axis = 0; axis < 3; ++axis) {
+            origin[axis][lane] = rayOrigin[axis];
+            direction[axis][lane] = rayDirection[axis];
+            inverseDirection[axis][lane] = 1.0f / rayDirection[axis];
+        }
+    }
+    std::array<float, 3> getOrigin(size_t lane) const { return { origin[0][lane], origin[1][lane], origin[2][lane] }; }
+    std::array<float, 3> getDirection(size_t lane) const { return { direction[0][lane], direction[1][lane], direction[2][lane] }; }
+};
+
+// bounding volume hierarchy over primitive bounds, built with the binned surface area heuristic
+class Bvh {
+public:
+    // flattened node, the children of an inner node are stored next to each other
+    struct Node {
+        std::array<float, 3> boundMin;
+        uint32_t firstChildOrPrimitive; // first child for inner nodes, first entry of primitiveIndices for leaves
+        std::array<float, 3> boundMax;
+        uint32_t primitiveCount; // 0 for inner nodes
+    };
+
+    static constexpr size_t MAX_LEAF_PRIMITIVES = 4;
+    static constexpr size_t MAX_DEPTH = 64;
+
+private:
+    std::vector<Node> nodes;
+    std::vector<uint32_t> primitiveIndices;
+
+public:
+    void build(const std::vector<Bounds>& primitiveBounds);
+
+    bool isEmpty() const { return nodes.empty(); }
+    const std::vector<Node>& getNodes() const { return nodes; }
+    const std::vector<uint32_t>& getPrimitiveIndices() const { return primitiveIndices; }
+
+    // distance along the ray to the node box, or a negative value when missed within tMax
+    static float intersectNode(const Node& node, const std::array<float, 3>& origin, const std::array<float, 3>& inverseDirection, float tMax) {
+        float tNear = 0.0f;
+        float tFar = tMax;
+        for (size_t axis = 0; axis < 3; ++axis) {
+            float t0 = (node.boundMin[axis] - origin[axis]) * inverseDirection[axis];
+            float t1 = (node.boundMax[axis] - origin[axis]) * inverseDirection[axis];
+            if (t0 > t1) {
+                std::swap(t0, t1);
+            }
+            tNear = std::max(tNear, t0);
+            tFar = std::min(tFar, t1);
+        }
+        return tNear <= tFar ? tNear : -1.0f;
+    }
+
+    // nearest distance to the node box among the lanes hitting it, or a negative value when all lanes miss
+    static float intersectNodePacket(const Node& node, const RayPacket& packet, const std::array<float, RayPacket::SIZE>& tMax) {
+#ifdef __wasm_simd128__
+        // pmin/pmax keep the first operand on NaN like the scalar std::min/std::max above
+        v128_t tNear = wasm_f32x4_splat(0.0f);
+        v128_t tFar = wasm_v128_load(tMax.data());
+        for (size_t axis = 0; axis < 3; ++axis) {
+            const v128_t origin = wasm_v128_load(packet.origin[axis].data());
+            const v128_t inverseDirection = wasm_v128_load(packet.inverseDirection[axis].data());
+            const v128_t t0 = wasm_f32x4_mul(wasm_f32x4_sub(wasm_f32x4_splat(node.boundMin[axis]), origin), inverseDirection);
+            const v128_t t1 = wasm_f32x4_mul(wasm_f32x4_sub(wasm_f32x4_splat(node.boundMax[axis]), origin), inverseDirection);
+            tNear = wasm_f32x4_pmax(tNear, wasm_f32x4_pmin(t0, t1));
+            tFar = wasm_f32x4_pmin(tFar, wasm_f32x4_pmax(t0, t1));
+        }
+        const v128_t hit = wasm_f32x4_le(tNear, tFar);
+        if (!wasm_v128_any_true(hit)) {
+            return -1.0f;
+        }
+        alignas(16) std::array<float, RayPacket::SIZE> distances;
+        wasm_v128_store(distances.data(), wasm_v128_bitselect(tNear, wasm_f32x4_splat(std::numeric_limits<float>::infinity()), hit));
+        return *std::min_element(distances.begin(), distances.end());
+#else
+        float nearest = -1.0f;
+        for (size_t lane = 0; lane < RayPacket::SIZE; ++lane) {
+            const std::array<float, 3> inverseDirection = {
+                packet.inverseDirection[0][lane], packet.inverseDirection[1][lane], packet.inverseDirection[2][lane]
+            };
+            const float distance = intersectNode(node, packet.getOrigin(lane), inverseDirection, tMax[lane]);
+            if (distance >= 0.0f && (nearest < 0.0f || distance < nearest)) {
+                nearest = distance;
+            }
+        }
+        return nearest;
+#endif
+    }
+
+    // visits the primitives of the leaves hit by the ray, nearest nodes first.
+    // visitPrimitive(primitiveIndex, tMax) lowers tMax on a hit, which prunes farther nodes.
+    template <typename Visitor>
+    void traverse(const std::array<float, 3>& origin, const std::array<float, 3>& direction, float& tMax, Visitor&& visitPrimitive) const {
+        if (nodes.empty()) {
+            return;
+        }
+        const std::array<float, 3> inverseDirection = { 1.0f / direction[0], 1.0f / direction[1], 1.0f / direction[2] };
+        if (intersectNode(nodes[0], origin, inverseDirection, tMax) < 0.0f) {
+            return;
+        }
+
+        std::array<uint32_t, MAX_DEPTH> stack;
+        size_t stackSize = 0;
+        uint32_t nodeIndex = 0;
+        while (true) {
+            const Node& node = nodes[nodeIndex];
+            if (node.primitiveCount > 0) {
+                for (uint32_t i = 0; i < node.primitiveCount; ++i) {
+                    visitPrimitive(primitiveIndices[node.firstChildOrPrimitive + i], tMax);
+                }
+            } else {
+                uint32_t nearChild = node.firstChildOrPrimitive;
+                uint32_t farChild = nearChild + 1;
+                float nearDistance = intersectNode(nodes[nearChild], origin, inverseDirection, tMax);
+                float farDistance = intersectNode(nodes[farChild], origin, inverseDirection, tMax);
+                if (farDistance >= 0.0f && (nearDistance < 0.0f || farDistance < nearDistance)) {
+                    std::swap(nearChild, farChild);
+                    std::swap(nearDistance, farDistance);
+                }
+                if (nearDistance >= 0.0f) {
+                    if (farDistance >= 0.0f) {
+                        stack[stackSize++] = farChild;
+                    }
+                    nodeIndex = nearChild;
+                    continue;
+                }
+            }
+
+            // pop, skipping nodes beyond a hit found meanwhile
+            bool found = false;
+            while (stackSize > 0 && !found) {
+                nodeIndex = stack[--stackSize];
+                found = intersectNode(nodes[nodeIndex], origin, inverseDirection, tMax) >= 0.0f;
+            }
+            if (!found) {
+                return;
+            }
+        }
+    }
+
+    // same as traverse for a packet; a node is entered when any lane hits it, so the visitor must test every lane.
+    // visitPrimitive(primitiveIndex, tMax) lowers the tMax of the lanes it hits.
+    template <typename Visitor>
+    void traversePacket(const RayPacket& packet, std::array<float, RayPacket::SIZE>& tMax, Visitor&& visitPrimitive) const {
+        if (nodes.empty() || intersectNodePacket(nodes[0], packet, tMax) < 0.0f) {
+            return;
+        }
+
+        std::array<uint32_t, MAX_DEPTH> stack;
+        size_t stackSize = 0;
+        uint32_t nodeIndex = 0;
+        while (true) {
+            const Node& node = nodes[nodeIndex];
+            if (node.primitiveCount > 0) {
+                for (uint32_t i = 0; i < node.primitiveCount; ++i) {
+                    visitPrimitive(primitiveIndices[node.firstChildOrPrimitive + i], tMax);
+                }
+            } else {
+                uint32_t nearChild = node.firstChildOrPrimitive;
+                uint32_t farChild = nearChild + 1;
+                float nearDistance = intersectNodePacket(nodes[nearChild], packet, tMax);
+                float farDistance = intersectNodePacket(nodes[farChild], packet, tMax);
+                if (farDistance >= 0.0f && (nearDistance < 0.0f || farDistance < nearDistance)) {
+                    std::swap(nearChild, farChild);
+                    std::swap(nearDistance, farDistance);
+                }
+                if (nearDistance >= 0.0f) {
+                    if (farDistance >= 0.0f) {
+                        stack[stackSize++] = farChild;
+                    }
+                    nodeIndex = nearChild;
+                    continue;
+                }
+            }
+
+            bool found = false;
+            while (stackSize > 0 && !found) {
+                nodeIndex = stack[--stackSize];
+                found = intersectNodePacket(nodes[nodeIndex], packet, tMax) >= 0.0f;
+            }
+            if (!found) {
+                return;
+            }
+        }
+    }
+};
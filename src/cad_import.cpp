@@ -5,20 +5,29 @@
 // the terms of the GNU Lesser General Public License version 2.1 as published
 // by the Free Software Foundation.
 
+#include "content_hash.hpp"
 #include "model_context.hpp"
+#include "task_progress.hpp"
 #ifdef __EMSCRIPTEN_PTHREADS__
 #include "async_task.hpp"
+#include "task_scheduler.hpp"
 #endif
 
 #include <emscripten/bind.h>
 #include <emscripten/val.h>
 
+#include <algorithm>
 #include <cstdint>
+#include <iostream>
 #include <vector>
 #include <streambuf>
 #include <istream>
 #include <optional>
+#include <deque>
 #ifdef __EMSCRIPTEN_PTHREADS__
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
 #include <thread>
 #endif
 #include <memory>
@@ -27,11 +36,133 @@
 #include <IFSelect_ReturnStatus.hxx>
 #include <TDocStd_Document.hxx>
 
+// exposes the buffer to the reader one window at a time, so that progress and cancellation
+// are tracked while reading
 class ByteStreamBuf : public std::streambuf {
+private:
+    static constexpr std::size_t WINDOW_SIZE = 1 << 20;
+
+    char* begin;
+    char* end;
+    char* reported; // end of the bytes already counted as processed
+    Handle(TaskProgress) progress;
+
 public:
-    ByteStreamBuf(const uint8_t* data, std::size_t size) {
-        char* p = const_cast<char*>(reinterpret_cast<const char*>(data));
-        setg(p, p, p + size);
+    ByteStreamBuf(const uint8_t* data, std::size_t size, const Handle(TaskProgress)& progress)
+        : progress(progress)
+    {
+        begin = const_cast<char*>(reinterpret_cast<const char*>(data));
+        end = begin + size;
+        reported = begin;
+        setg(begin, begin, begin + std::min(size, WINDOW_SIZE));
+    }
+
+protected:
+    int_type underflow() override {
+        if (gptr() < egptr()) {
+            return traits_type::to_int_type(*gptr());
+        }
+
+        progress->addItems(static_cast<uint32_t>(egptr() - reported));
+        reported = egptr();
+        // an empty buffer is fully read
+        progress->setFraction(end == begin ? 1.0f : static_cast<float>(egptr() - begin) / static_cast<float>(end - begin));
+        if (egptr() == end || progress->isCancelled()) {
+            return traits_type::eof();
+        }
+
+        char* p = egptr();
+        setg(p, p, p + std::min<std::size_t>(end - p, WINDOW_SIZE));
+        return traits_type::to_int_type(*gptr());
+    }
+};
+
+// refills the get area from pushed chunks, releasing each chunk once the reader moves past it
+class ChunkStreamBuf : public std::streambuf {
+private:
+    std::deque<std::vector<uint8_t>> chunks;
+    std::vector<uint8_t> current;
+    bool finished = false;
+    ContentHasher hasher; // of the pushed chunks
+    Handle(TaskProgress) progress;
+#ifdef __EMSCRIPTEN_PTHREADS__
+    std::mutex mutex;
+    std::condition_variable chunkAvailable;
+#endif
+
+public:
+    explicit ChunkStreamBuf(const Handle(TaskProgress)& progress)
+        : progress(progress)
+    {
+    }
+
+    // chunks pushed after a cancel are dropped, as no reader will consume them
+    void push(std::vector<uint8_t>&& chunk) {
+        if (chunk.empty() || progress->isCancelled()) {
+            return;
+        }
+        {
+#ifdef __EMSCRIPTEN_PTHREADS__
+            std::lock_guard<std::mutex> lock(mutex);
+#endif
+            hasher.update(chunk.data(), chunk.size());
+            chunks.push_back(std::move(chunk));
+        }
+#ifdef __EMSCRIPTEN_PTHREADS__
+        chunkAvailable.notify_one();
+#endif
+    }
+
+    void finish() {
+        {
+#ifdef __EMSCRIPTEN_PTHREADS__
+            std::lock_guard<std::mutex> lock(mutex);
+#endif
+            finished = true;
+        }
+#ifdef __EMSCRIPTEN_PTHREADS__
+        chunkAvailable.notify_one();
+#endif
+    }
+
+    uint64_t getContentHash() {
+#ifdef __EMSCRIPTEN_PTHREADS__
+        std::lock_guard<std::mutex> lock(mutex);
+#endif
+        return hasher.digest();
+    }
+
+protected:
+    int_type underflow() override {
+        if (gptr() < egptr()) {
+            return traits_type::to_int_type(*gptr());
+        }
+
+        // the current chunk is fully consumed
+        progress->addItems(static_cast<uint32_t>(current.size()));
+        current = std::vector<uint8_t>();
+        setg(nullptr, nullptr, nullptr);
+
+        {
+#ifdef __EMSCRIPTEN_PTHREADS__
+            // blocks the reader thread until more data is downloaded
+            std::unique_lock<std::mutex> lock(mutex);
+            chunkAvailable.wait(lock, [this]() { return !chunks.empty() || finished; });
+#endif
+            if (progress->isCancelled()) {
+                chunks.clear();
+                return traits_type::eof();
+            }
+            if (chunks.empty()) {
+                return traits_type::eof();
+            }
+            current = std::move(chunks.front());
+            chunks.pop_front();
+        }
+
+        char* p = reinterpret_cast<char*>(current.data());
+        setg(p, p, p + current.size());
+        return traits_type::to_int_type(*gptr());
     }
 };
 
@@ -39,24 +170,39 @@ public:
 using CadImportAsyncTask = AsyncTask<ModelContext>;
 #endif
 
+class StepImportSession;
+
 class CadImport {
+    friend class StepImportSession;
+
 private:
-    static std::optional<ModelContext> fromStepInternal(std::vector<uint8_t> data) {
+    static std::optional<ModelContext> fromStepInternal(const uint8_t* data, std::size_t size, const Handle(TaskProgress)& progress) {
+        progress->setPhase(TaskPhase::Reading, static_cast<uint32_t>(size));
+        ByteStreamBuf byteStreamBuf(data, size, progress);
+        std::istream stream(&byteStreamBuf);
+        std::optional<ModelContext> result = fromStepStream(stream, progress);
+        if (result.has_value()) {
+            result->setContentHash(ContentHasher::hash(data, size));
+        }
+        return result;
+    }
+
+    // the caller sets the reading phase, as only it knows the stream size
+    static std::optional<ModelContext> fromStepStream(std::istream& stream, const Handle(TaskProgress)& progress) {
         STEPCAFControl_Reader stepCafReader;
         stepCafReader.SetProductMetaMode(Standard_True);
 
-        ByteStreamBuf byteStreamBuf(data.data(), data.size());
-        std::istream stream(&byteStreamBuf);
-
         Handle(TDocStd_Document) doc = new TDocStd_Document("BinXCAF");
         try {
             OCC_CATCH_SIGNALS
             IFSelect_ReturnStatus status = stepCafReader.ReadStream("stp", stream);
-            if (status != IFSelect_RetDone) {
+            // a cancelled stream ends early, so the reader may still report success
+            if (status != IFSelect_RetDone || progress->isCancelled()) {
                 return std::nullopt;
             }
             
-            if (!stepCafReader.Transfer(doc)) {
+            progress->setPhase(TaskPhase::Transferring);
+            if (!stepCafReader.Transfer(doc, progress->Start()) || progress->isCancelled()) {
                 return std::nullopt;
             }
         } catch (const Standard_Failure& e) {
@@ -68,30 +214,236 @@ private:
     }
 
 public:
+    static StepImportSession beginStep();
+
     static std::optional<ModelContext> fromStep(const Uint8Array& buffer) {
         std::vector<uint8_t> data = emscripten::convertJSArrayToNumberVector<uint8_t>(buffer);
-        return fromStepInternal(std::move(data));
+        return fromStepInternal(data.data(), data.size(), new TaskProgress());
+    }
+
+    // parses the buffer in place, without copying it out of the wasm heap
+    static std::optional<ModelContext> fromStepBuffer(const ByteBuffer& buffer) {
+        return fromStepInternal(buffer.getData(), buffer.getSize(), new TaskProgress());
     }
 
 #ifdef __EMSCRIPTEN_PTHREADS__
-    static void fromStepAsync(const Uint8Array& buffer, CadImportAsyncTask& task) {
-        std::vector<uint8_t> data = emscripten::convertJSArrayToNumberVector<uint8_t>(buffer);
-        std::thread([data = std::move(data), &task]() {
-            task.setValue(fromStepInternal(std::move(data)));
+    // the returned promise resolves once the task is completed
+    static emscripten::val fromStepAsync(const Uint8Array& buffer, CadImportAsyncTask& task) {
+        return fromStepAsyncWithPriority(buffer, task, TaskPriority::Normal);
+    }
+
+    static emscripten::val fromStepAsyncWithPriority(const Uint8Array& buffer, CadImportAsyncTask& task, TaskPriority priority) {
+        emscripten::val promise = task.createPromise();
+        auto data = std::make_shared<std::vector<uint8_t>>(emscripten::convertJSArrayToNumberVector<uint8_t>(buffer));
+        TaskScheduler::instance().submit([data, &task]() {
+            task.setValue(fromStepInternal(data->data(), data->size(), task.getProgressIndicator()));
+        }, priority);
+        return promise;
+    }
+
+    // takes over the buffer memory, leaving the JS-side ByteBuffer empty
+    static emscripten::val fromStepBufferAsync(ByteBuffer& buffer, CadImportAsyncTask& task) {
+        return fromStepBufferAsyncWithPriority(buffer, task, TaskPriority::Normal);
+    }
+
+    static emscripten::val fromStepBufferAsyncWithPriority(ByteBuffer& buffer, CadImportAsyncTask& task, TaskPriority priority) {
+        emscripten::val promise = task.createPromise();
+        auto data = std::make_shared<ByteBuffer>(std::move(buffer));
+        TaskScheduler::instance().submit([data, &task]() {
+            task.setValue(fromStepInternal(data->getData(), data->getSize(), task.getProgressIndicator()));
+        }, priority);
+        return promise;
+    }
+#endif
+};
+
+// incremental STEP import, fed chunk by chunk while the file is still being downloaded.
+// in multithreaded builds the reader runs on its own thread as soon as the session begins,
+// otherwise the pushed chunks are parsed on finish() and released as the reader consumes them.
+// the number of concurrent readers is capped, a session begun beyond the cap finishes without a model.
+class StepImportSession {
+private:
+#ifdef __EMSCRIPTEN_PTHREADS__
+    // each reader holds a thread of the fixed pthread pool for as long as its download takes.
+    // the scheduler and the OCCT thread pool share the pool, so readers get a quarter of it at most.
+    static size_t getMaxReaderCount() {
+        static const size_t maxReaderCount = std::max<size_t>(1, std::thread::hardware_concurrency() / 4);
+        return maxReaderCount;
+    }
+
+    static std::atomic<size_t> readerCount;
+
+    static bool acquireReader() {
+        size_t count = readerCount.load();
+        do {
+            if (count >= getMaxReaderCount()) {
+                return false;
+            }
+        } while (!readerCount.compare_exchange_weak(count, count + 1));
+        return true;
+    }
+#endif
+
+    struct State {
+        Handle(TaskProgress) progress;
+        ChunkStreamBuf streamBuf;
+#ifdef __EMSCRIPTEN_PTHREADS__
+        std::mutex mutex;
+        std::condition_variable completedCondition;
+        bool completed = false;
+        bool taken = false;
+        std::optional<ModelContext> result;
+        CadImportAsyncTask* task = nullptr;
+#endif
+
+        State()
+            : progress(new TaskProgress())
+            , streamBuf(progress)
+        {
+        }
+    };
+
+    std::shared_ptr<State> state;
+
+public:
+    StepImportSession()
+        : state(std::make_shared<State>())
+    {
+#ifdef __EMSCRIPTEN_PTHREADS__
+        if (!acquireReader()) {
+            // fails without a reader, rather than exhausting the pthread pool
+            std::cerr << "STEP import error: too many import sessions in progress" << std::endl;
+            state->progress->cancel();
+            state->completed = true;
+            return;
+        }
+
+        // the reader blocks on the stream until chunks arrive, for as long as the download takes.
+        // it gets a thread of its own rather than a scheduler worker, so that other tasks are not
+        // held up behind it and finish() never waits for a reader still queued behind a busy worker.
+        std::thread([state = state]() {
+            state->progress->setPhase(TaskPhase::Reading);
+            std::istream stream(&state->streamBuf);
+            std::optional<ModelContext> result = CadImport::fromStepStream(stream, state->progress);
+            if (result.has_value()) {
+                // the reader reaches the end of the stream only after finish(), so every chunk is hashed
+                result->setContentHash(state->streamBuf.getContentHash());
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                if (state->task != nullptr) {
+                    state->task->setValue(std::move(result));
+                } else {
+                    state->result = std::move(result);
+                }
+                state->completed = true;
+            }
+            state->completedCondition.notify_all();
+            --readerCount;
         }).detach();
+#endif
+    }
+
+    StepImportSession(StepImportSession&&) = default;
+
+    ~StepImportSession() {
+#ifdef __EMSCRIPTEN_PTHREADS__
+        if (state) {
+            // let an abandoned reader run into end of stream, it releases the state when done
+            state->streamBuf.finish();
+        }
+#endif
+    }
+
+    void pushChunk(const Uint8Array& chunk) {
+        std::vector<uint8_t> data(chunk["length"].as<std::size_t>());
+        emscripten::val(emscripten::typed_memory_view(data.size(), data.data())).call<void>("set", chunk);
+        state->streamBuf.push(std::move(data));
+    }
+
+    std::optional<ModelContext> finish() {
+        state->streamBuf.finish();
+#ifdef __EMSCRIPTEN_PTHREADS__
+        std::unique_lock<std::mutex> lock(state->mutex);
+        if (state->taken) {
+            return std::nullopt;
+        }
+        state->completedCondition.wait(lock, [this]() { return state->completed; });
+        state->taken = true;
+        return std::move(state->result);
+#else
+        state->progress->setPhase(TaskPhase::Reading);
+        std::istream stream(&state->streamBuf);
+        std::optional<ModelContext> result = CadImport::fromStepStream(stream, state->progress);
+        if (result.has_value()) {
+            result->setContentHash(state->streamBuf.getContentHash());
+        }
+        return result;
+#endif
+    }
+
+    // stops the reader and drops the chunks which are still queued
+    void cancel() {
+        state->progress->cancel();
+        state->streamBuf.finish();
+    }
+
+#ifdef __EMSCRIPTEN_PTHREADS__
+    // completes the task once the reader is done, without blocking the calling thread
+    emscripten::val finishAsync(CadImportAsyncTask& task) {
+        emscripten::val promise = task.createPromise();
+        if (task.isCancelled()) {
+            state->progress->cancel();
+        }
+        task.setProgressIndicator(state->progress);
+        state->streamBuf.finish();
+
+        std::lock_guard<std::mutex> lock(state->mutex);
+        if (state->taken) {
+            task.setValue(std::nullopt);
+        } else if (state->completed) {
+            task.setValue(std::move(state->result));
+        } else {
+            state->task = &task;
+        }
+        state->taken = true;
+        return promise;
     }
 #endif
 };
 
+#ifdef __EMSCRIPTEN_PTHREADS__
+std::atomic<size_t> StepImportSession::readerCount { 0 };
+#endif
+
+StepImportSession CadImport::beginStep() {
+    return StepImportSession();
+}
+
 EMSCRIPTEN_BINDINGS(model_context) {
 #ifdef __EMSCRIPTEN_PTHREADS__
     CREATE_EMSCRIPTEN_ASYNC_TASK_BINDINGS(CadImportAsyncTask)
 #endif
 
+    emscripten::class_<StepImportSession>("StepImportSession")
+        .function("pushChunk", &StepImportSession::pushChunk)
+        .function("finish", &StepImportSession::finish, emscripten::return_value_policy::take_ownership())
+        .function("cancel", &StepImportSession::cancel)
+#ifdef __EMSCRIPTEN_PTHREADS__
+        .function("finishAsync", &StepImportSession::finishAsync)
+#endif
+        ;
+
     emscripten::class_<CadImport>("CadImport")
         .class_function("fromStep", &CadImport::fromStep, emscripten::return_value_policy::take_ownership())
+        .class_function("fromStepBuffer", &CadImport::fromStepBuffer, emscripten::return_value_policy::take_ownership())
+        .class_function("beginStep", &CadImport::beginStep, emscripten::return_value_policy::take_ownership())
 #ifdef __EMSCRIPTEN_PTHREADS__
         .class_function("fromStepAsync", &CadImport::fromStepAsync)
+        .class_function("fromStepAsync", &CadImport::fromStepAsyncWithPriority)
+        .class_function("fromStepBufferAsync", &CadImport::fromStepBufferAsync)
+        .class_function("fromStepBufferAsync", &CadImport::fromStepBufferAsyncWithPriority)
 #endif
         ;
 }
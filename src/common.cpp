@@ -9,8 +9,26 @@
 
 #include <emscripten/bind.h>
 
+// ByteBuffer methods
+
+size_t ByteBuffer::getSize() const {
+    return size;
+}
+
+Uint8Array ByteBuffer::getView() const {
+    emscripten::memory_view view(size, reinterpret_cast<const uint8_t*>(data.get()));
+    return Uint8Array(emscripten::val(view));
+}
+
 EMSCRIPTEN_BINDINGS(common_module) {
     emscripten::register_type<Uint8Array>("Uint8Array");
+    emscripten::register_type<Uint16Array>("Uint16Array");
     emscripten::register_type<Uint32Array>("Uint32Array");
+    emscripten::register_type<Int32Array>("Int32Array");
     emscripten::register_type<Float32Array>("Float32Array");
+
+    emscripten::class_<ByteBuffer>("ByteBuffer")
+        .constructor<size_t>()
+        .function("getSize", &ByteBuffer::getSize)
+        .function("getView", &ByteBuffer::getView);
 }
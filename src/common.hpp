@@ -9,6 +9,51 @@
 
 #include <emscripten/val.h>
 
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
 EMSCRIPTEN_DECLARE_VAL_TYPE(Uint8Array);
+EMSCRIPTEN_DECLARE_VAL_TYPE(Uint16Array);
 EMSCRIPTEN_DECLARE_VAL_TYPE(Uint32Array);
+EMSCRIPTEN_DECLARE_VAL_TYPE(Int32Array);
 EMSCRIPTEN_DECLARE_VAL_TYPE(Float32Array);
+
+// wasm-owned byte buffer which JS can fill in place through getView()
+class ByteBuffer {
+private:
+    std::unique_ptr<uint8_t[]> data;
+    size_t size;
+
+public:
+    explicit ByteBuffer(size_t size)
+        : data(new uint8_t[size]) // left uninitialized, JS is expected to overwrite it
+        , size(size)
+    {
+    }
+
+    ByteBuffer(ByteBuffer&& other) noexcept
+        : data(std::move(other.data))
+        , size(other.size)
+    {
+        other.size = 0;
+    }
+
+    ByteBuffer& operator=(ByteBuffer&& other) noexcept {
+        if (this != &other) {
+            data = std::move(other.data);
+            size = other.size;
+            other.size = 0;
+        }
+        return *this;
+    }
+
+    ByteBuffer(const ByteBuffer&) = delete;
+    ByteBuffer& operator=(const ByteBuffer&) = delete;
+
+    const uint8_t* getData() const { return data.get(); }
+    uint8_t* getData() { return data.get(); }
+    size_t getSize() const;
+    // NOTE: the view is invalidated when the wasm memory grows, so fetch it right before writing
+    Uint8Array getView() const;
+};
@@ -0,0 +1,141 @@
+// Copyright (c) 2025 SolverX Corporation
+// This file is part of MIE OpenCascade WebAssembly Bindings.
+//
+// This library is free software; you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License version 2.1 as published
+// by the Free Software Foundation.
+
+#include "content_hash.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+constexpr uint64_t PRIME1 = 0x9E3779B185EBCA87ull;
+constexpr uint64_t PRIME2 = 0xC2B2AE3D27D4EB4Full;
+constexpr uint64_t PRIME3 = 0x165667B19E3779F9ull;
+constexpr uint64_t PRIME4 = 0x85EBCA77C2B2AE63ull;
+constexpr uint64_t PRIME5 = 0x27D4EB2F165667C5ull;
+
+uint64_t rotateLeft(uint64_t value, int bits) {
+    return (value << bits) | (value >> (64 - bits));
+}
+
+// little-endian like wasm memory, unaligned reads go through memcpy
+uint64_t read64(const uint8_t* data) {
+    uint64_t value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+uint32_t read32(const uint8_t* data) {
+    uint32_t value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+uint64_t round(uint64_t accumulator, uint64_t input) {
+    accumulator += input * PRIME2;
+    accumulator = rotateLeft(accumulator, 31);
+    return accumulator * PRIME1;
+}
+
+uint64_t mergeRound(uint64_t hash, uint64_t accumulator) {
+    hash ^= round(0, accumulator);
+    return hash * PRIME1 + PRIME4;
+}
+
+void consumeStripe(std::array<uint64_t, 4>& accumulators, const uint8_t* data) {
+    for (size_t lane = 0; lane < 4; ++lane) {
+        accumulators[lane] = round(accumulators[lane], read64(data + lane * 8));
+    }
+}
+
+} // namespace
+
+ContentHasher::ContentHasher(uint64_t seed)
+    : seed(seed)
+    , accumulators({ seed + PRIME1 + PRIME2, seed + PRIME2, seed, seed - PRIME1 })
+{
+}
+
+void ContentHasher::update(const void* data, size_t size) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    totalSize += size;
+
+    if (stripeSize > 0) {
+        const size_t fillSize = std::min(size, stripe.size() - stripeSize);
+        std::memcpy(stripe.data() + stripeSize, bytes, fillSize);
+        stripeSize += fillSize;
+        bytes += fillSize;
+        size -= fillSize;
+        if (stripeSize < stripe.size()) {
+            return;
+        }
+        consumeStripe(accumulators, stripe.data());
+        stripeSize = 0;
+    }
+
+    for (; size >= stripe.size(); bytes += stripe.size(), size -= stripe.size()) {
+        consumeStripe(accumulators, bytes);
+    }
+
+    if (size > 0) {
+        std::memcpy(stripe.data(), bytes, size);
+        stripeSize = size;
+    }
+}
+
+uint64_t ContentHasher::digest() const {
+    uint64_t hash;
+    if (totalSize >= stripe.size()) {
+        hash = rotateLeft(accumulators[0], 1) + rotateLeft(accumulators[1], 7)
+            + rotateLeft(accumulators[2], 12) + rotateLeft(accumulators[3], 18);
+        for (uint64_t accumulator : accumulators) {
+            hash = mergeRound(hash, accumulator);
+        }
+    } else {
+        hash = seed + PRIME5;
+    }
+    hash += totalSize;
+
+    const uint8_t* tail = stripe.data();
+    const uint8_t* tailEnd = tail + stripeSize;
+    for (; tail + 8 <= tailEnd; tail += 8) {
+        hash ^= round(0, read64(tail));
+        hash = rotateLeft(hash, 27) * PRIME1 + PRIME4;
+    }
+    if (tail + 4 <= tailEnd) {
+        hash ^= static_cast<uint64_t>(read32(tail)) * PRIME1;
+        hash = rotateLeft(hash, 23) * PRIME2 + PRIME3;
+        tail += 4;
+    }
+    for (; tail < tailEnd; ++tail) {
+        hash ^= static_cast<uint64_t>(*tail) * PRIME5;
+        hash = rotateLeft(hash, 11) * PRIME1;
+    }
+
+    // avalanche
+    hash ^= hash >> 33;
+    hash *= PRIME2;
+    hash ^= hash >> 29;
+    hash *= PRIME3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+uint64_t ContentHasher::hash(const void* data, size_t size, uint64_t seed) {
+    ContentHasher hasher(seed);
+    hasher.update(data, size);
+    return hasher.digest();
+}
+
+std::string ContentHasher::toHex(uint64_t hash) {
+    static constexpr char DIGITS[] = "0123456789abcdef";
+    std::string hex(16, '0');
+    for (size_t i = 0; i < hex.size(); ++i) {
+        hex[hex.size() - 1 - i] = DIGITS[(hash >> (i * 4)) & 0xF];
+    }
+    return hex;
+}
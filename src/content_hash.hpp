@@ -0,0 +1,34 @@
+// Copyright (c) 2025 SolverX Corporation
+// This file is part of MIE OpenCascade WebAssembly Bindings.
+//
+// This library is free software; you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License version 2.1 as published
+// by the Free Software Foundation.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// streaming XXH64, to key caches by content. fast but not collision resistant against crafted input.
+class ContentHasher {
+private:
+    uint64_t seed;
+    std::array<uint64_t, 4> accumulators;
+    std::array<uint8_t, 32> stripe; // bytes not yet folded into the accumulators
+    size_t stripeSize = 0;
+    uint64_t totalSize = 0;
+
+public:
+    explicit ContentHasher(uint64_t seed = 0);
+
+    void update(const void* data, size_t size);
+    // hash of the bytes so far, more bytes can still be added afterwards
+    uint64_t digest() const;
+
+    static uint64_t hash(const void* data, size_t size, uint64_t seed = 0);
+    // 16 lowercase hex digits
+    static std::string toHex(uint64_t hash);
+};
@@ -0,0 +1,337 @@
+// Copyright (c) 2025 SolverX Corporation
+// This file is part of MIE OpenCascade WebAssembly Bindings.
+//
+// This library is free software; you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License version 2.1 as published
+// by the Free Software Foundation.
+
+#include "mesh_optimizer.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+// from Tom Forsyth, "Linear-Speed Vertex Cache Optimisation"
+constexpr size_t CACHE_SIZE = 32;
+constexpr float CACHE_DECAY_POWER = 1.5f;
+constexpr float LAST_TRIANGLE_SCORE = 0.75f;
+constexpr float VALENCE_BOOST_SCALE = 2.0f;
+constexpr float VALENCE_BOOST_POWER = 0.5f;
+
+float computeVertexScore(int cachePosition, uint32_t remainingTriangles) {
+    if (remainingTriangles == 0) {
+        return -1.0f; // no triangle needs the vertex anymore
+    }
+
+    float score = 0.0f;
+    if (cachePosition >= 0) {
+        if (cachePosition < 3) {
+            // used by the last triangle, fixed score to avoid favoring any of its edges
+            score = LAST_TRIANGLE_SCORE;
+        } else {
+            const float scaler = 1.0f / static_cast<float>(CACHE_SIZE - 3);
+            score = std::pow(1.0f - static_cast<float>(cachePosition - 3) * scaler, CACHE_DECAY_POWER);
+        }
+    }
+    // favor vertices with few triangles left, so that they leave the working set early
+    score += VALENCE_BOOST_SCALE * std::pow(static_cast<float>(remainingTriangles), -VALENCE_BOOST_POWER);
+    return score;
+}
+
+void appendMeshletBounds(
+    const uint32_t* meshletVertices,
+    size_t meshletVertexCount,
+    const uint8_t* meshletTriangles,
+    size_t meshletTriangleCount,
+    const float* positions,
+    size_t positionStride,
+    std::vector<float>& meshletBounds
+) {
+    auto position = [&](uint32_t vertex) {
+        const float* p = positions + static_cast<size_t>(vertex) * positionStride;
+        return std::array<float, 3>{ p[0], p[1], p[2] };
+    };
+
+    // bounding sphere around the box center
+    std::array<float, 3> boundMin = position(meshletVertices[0]);
+    std::array<float, 3> boundMax = boundMin;
+    for (size_t i = 1; i < meshletVertexCount; ++i) {
+        const std::array<float, 3> p = position(meshletVertices[i]);
+        for (size_t axis = 0; axis < 3; ++axis) {
+            boundMin[axis] = std::min(boundMin[axis], p[axis]);
+            boundMax[axis] = std::max(boundMax[axis], p[axis]);
+        }
+    }
+    const std::array<float, 3> center = {
+        (boundMin[0] + boundMax[0]) * 0.5f,
+        (boundMin[1] + boundMax[1]) * 0.5f,
+        (boundMin[2] + boundMax[2]) * 0.5f
+    };
+    float radiusSquared = 0.0f;
+    for (size_t i = 0; i < meshletVertexCount; ++i) {
+        const std::array<float, 3> p = position(meshletVertices[i]);
+        const float dx = p[0] - center[0], dy = p[1] - center[1], dz = p[2] - center[2];
+        radiusSquared = std::max(radiusSquared, dx * dx + dy * dy + dz * dz);
+    }
+
+    // normal cone from the face normals of the triangles
+    std::vector<std::array<float, 3>> triangleNormals;
+    triangleNormals.reserve(meshletTriangleCount);
+    std::array<float, 3> axis = { 0.0f, 0.0f, 0.0f };
+    for (size_t t = 0; t < meshletTriangleCount; ++t) {
+        const std::array<float, 3> a = position(meshletVertices[meshletTriangles[t * 3]]);
+        const std::array<float, 3> b = position(meshletVertices[meshletTriangles[t * 3 + 1]]);
+        const std::array<float, 3> c = position(meshletVertices[meshletTriangles[t * 3 + 2]]);
+        const std::array<float, 3> ab = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+        const std::array<float, 3> ac = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+        std::array<float, 3> normal = {
+            ab[1] * ac[2] - ab[2] * ac[1],
+            ab[2] * ac[0] - ab[0] * ac[2],
+            ab[0] * ac[1] - ab[1] * ac[0]
+        };
+        const float length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+        if (length == 0.0f) {
+            continue; // degenerate triangle
+        }
+        for (size_t k = 0; k < 3; ++k) {
+            normal[k] /= length;
+            axis[k] += normal[k];
+        }
+        triangleNormals.push_back(normal);
+    }
+
+    float coneCutoff = 1.0f;
+    const float axisLength = std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+    if (axisLength > 0.0f && !triangleNormals.empty()) {
+        for (size_t k = 0; k < 3; ++k) {
+            axis[k] /= axisLength;
+        }
+        float minDot = 1.0f;
+        for (const std::array<float, 3>& normal : triangleNormals) {
+            minDot = std::min(minDot, normal[0] * axis[0] + normal[1] * axis[1] + normal[2] * axis[2]);
+        }
+        if (minDot > 0.0f) {
+            coneCutoff = std::sqrt(1.0f - minDot * minDot);
+        }
+    } else {
+        axis = { 0.0f, 0.0f, 0.0f };
+    }
+
+    meshletBounds.insert(meshletBounds.end(), {
+        center[0], center[1], center[2], std::sqrt(radiusSquared),
+        axis[0], axis[1], axis[2], coneCutoff
+    });
+}
+
+} // namespace
+
+void MeshOptimizer::optimizeVertexCache(uint32_t* indices, size_t indexCount, uint32_t vertexBase, size_t vertexCount) {
+    const size_t triangleCount = indexCount / 3;
+    if (triangleCount < 2) {
+        return;
+    }
+
+    // active triangles of each vertex, emitted ones are swapped past the remaining count
+    std::vector<uint32_t> remainingTriangles(vertexCount, 0);
+    for (size_t i = 0; i < triangleCount * 3; ++i) {
+        ++remainingTriangles[indices[i] - vertexBase];
+    }
+    std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+    for (size_t v = 0; v < vertexCount; ++v) {
+        adjacencyOffsets[v + 1] = adjacencyOffsets[v] + remainingTriangles[v];
+    }
+    std::vector<uint32_t> adjacency(triangleCount * 3);
+    {
+        std::vector<uint32_t> fillOffsets(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+        for (size_t i = 0; i < triangleCount * 3; ++i) {
+            adjacency[fillOffsets[indices[i] - vertexBase]++] = static_cast<uint32_t>(i / 3);
+        }
+    }
+
+    std::vector<int> cachePositions(vertexCount, -1);
+    std::vector<float> vertexScores(vertexCount);
+    for (size_t v = 0; v < vertexCount; ++v) {
+        vertexScores[v] = computeVertexScore(-1, remainingTriangles[v]);
+    }
+
+    constexpr size_t NO_TRIANGLE = std::numeric_limits<size_t>::max();
+    std::vector<float> triangleScores(triangleCount);
+    std::vector<bool> emittedTriangles(triangleCount, false);
+    size_t bestTriangle = NO_TRIANGLE;
+    float bestScore = -1.0f;
+    for (size_t t = 0; t < triangleCount; ++t) {
+        triangleScores[t] = vertexScores[indices[t * 3] - vertexBase]
+            + vertexScores[indices[t * 3 + 1] - vertexBase]
+            + vertexScores[indices[t * 3 + 2] - vertexBase];
+        if (triangleScores[t] > bestScore) {
+            bestScore = triangleScores[t];
+            bestTriangle = t;
+        }
+    }
+
+    std::vector<uint32_t> output(triangleCount * 3);
+    std::vector<uint32_t> cache;
+    std::vector<uint32_t> newCache;
+    cache.reserve(CACHE_SIZE + 3);
+    newCache.reserve(CACHE_SIZE + 3);
+    size_t scanCursor = 0;
+
+    for (size_t emitted = 0; emitted < triangleCount; ++emitted) {
+        if (bestTriangle == NO_TRIANGLE) {
+            // no candidate left in the cache, continue with the next triangle in input order
+            while (emittedTriangles[scanCursor]) {
+                ++scanCursor;
+            }
+            bestTriangle = scanCursor;
+        }
+
+        const uint32_t* triangle = indices + bestTriangle * 3;
+        std::copy_n(triangle, 3, output.begin() + emitted * 3);
+        emittedTriangles[bestTriangle] = true;
+
+        newCache.clear();
+        for (size_t k = 0; k < 3; ++k) {
+            const uint32_t v = triangle[k] - vertexBase;
+            // remove the triangle from the active list of the vertex
+            uint32_t* activeBegin = adjacency.data() + adjacencyOffsets[v];
+            uint32_t* activeEnd = activeBegin + remainingTriangles[v];
+            uint32_t* found = std::find(activeBegin, activeEnd, static_cast<uint32_t>(bestTriangle));
+            std::swap(*found, *(activeEnd - 1));
+            --remainingTriangles[v];
+
+            if (std::find(newCache.begin(), newCache.end(), v) == newCache.end()) {
+                newCache.push_back(v);
+            }
+        }
+        for (uint32_t v : cache) {
+            if (std::find(newCache.begin(), newCache.end(), v) == newCache.end()) {
+                newCache.push_back(v);
+            }
+        }
+
+        for (size_t i = 0; i < newCache.size(); ++i) {
+            const uint32_t v = newCache[i];
+            cachePositions[v] = i < CACHE_SIZE ? static_cast<int>(i) : -1;
+            vertexScores[v] = computeVertexScore(cachePositions[v], remainingTriangles[v]);
+        }
+
+        // only the triangles around the touched vertices change their score
+        bestTriangle = NO_TRIANGLE;
+        bestScore = -1.0f;
+        for (uint32_t v : newCache) {
+            const uint32_t* activeBegin = adjacency.data() + adjacencyOffsets[v];
+            const uint32_t* activeEnd = activeBegin + remainingTriangles[v];
+            for (const uint32_t* it = activeBegin; it != activeEnd; ++it) {
+                const uint32_t t = *it;
+                triangleScores[t] = vertexScores[indices[t * 3] - vertexBase]
+                    + vertexScores[indices[t * 3 + 1] - vertexBase]
+                    + vertexScores[indices[t * 3 + 2] - vertexBase];
+                if (triangleScores[t] > bestScore) {
+                    bestScore = triangleScores[t];
+                    bestTriangle = t;
+                }
+            }
+        }
+
+        if (newCache.size() > CACHE_SIZE) {
+            newCache.resize(CACHE_SIZE);
+        }
+        cache.swap(newCache);
+    }
+
+    std::copy(output.begin(), output.end(), indices);
+}
+
+void MeshOptimizer::buildVertexFetchRemap(const uint32_t* indices, size_t indexCount, uint32_t vertexBase, size_t vertexCount, uint32_t* remap) {
+    constexpr uint32_t UNUSED = std::numeric_limits<uint32_t>::max();
+    std::fill(remap, remap + vertexCount, UNUSED);
+
+    uint32_t nextVertex = 0;
+    for (size_t i = 0; i < indexCount; ++i) {
+        if (indices[i] < vertexBase || indices[i] - vertexBase >= vertexCount) {
+            continue;
+        }
+        uint32_t& newVertex = remap[indices[i] - vertexBase];
+        if (newVertex == UNUSED) {
+            newVertex = nextVertex++;
+        }
+    }
+    for (size_t v = 0; v < vertexCount; ++v) {
+        if (remap[v] == UNUSED) {
+            remap[v] = nextVertex++;
+        }
+    }
+}
+
+void MeshOptimizer::buildMeshlets(
+    const uint32_t* indices,
+    size_t indexCount,
+    const float* positions,
+    size_t positionStride,
+    size_t vertexCount,
+    std::vector<uint32_t>& meshlets,
+    std::vector<uint32_t>& meshletVertices,
+    std::vector<uint8_t>& meshletTriangles,
+    std::vector<float>& meshletBounds
+) {
+    meshlets.clear();
+    meshletVertices.clear();
+    meshletTriangles.clear();
+    meshletBounds.clear();
+
+    constexpr uint8_t NOT_IN_MESHLET = 0xff;
+    std::vector<uint8_t> localIndices(vertexCount, NOT_IN_MESHLET);
+    size_t vertexOffset = 0;
+    size_t triangleOffset = 0; // in triangles
+
+    auto flushMeshlet = [&]() {
+        const size_t meshletVertexCount = meshletVertices.size() - vertexOffset;
+        const size_t meshletTriangleCount = meshletTriangles.size() / 3 - triangleOffset;
+        if (meshletTriangleCount == 0) {
+            return;
+        }
+        meshlets.insert(meshlets.end(), {
+            static_cast<uint32_t>(vertexOffset),
+            static_cast<uint32_t>(triangleOffset),
+            static_cast<uint32_t>(meshletVertexCount),
+            static_cast<uint32_t>(meshletTriangleCount)
+        });
+        appendMeshletBounds(
+            meshletVertices.data() + vertexOffset, meshletVertexCount,
+            meshletTriangles.data() + triangleOffset * 3, meshletTriangleCount,
+            positions, positionStride, meshletBounds);
+        for (size_t i = vertexOffset; i < meshletVertices.size(); ++i) {
+            localIndices[meshletVertices[i]] = NOT_IN_MESHLET;
+        }
+        vertexOffset = meshletVertices.size();
+        triangleOffset = meshletTriangles.size() / 3;
+    };
+
+    for (size_t i = 0; i + 2 < indexCount; i += 3) {
+        size_t newVertexCount = 0;
+        for (size_t k = 0; k < 3; ++k) {
+            const uint32_t vertex = indices[i + k];
+            const bool repeated = (k > 0 && indices[i] == vertex) || (k > 1 && indices[i + 1] == vertex);
+            if (localIndices[vertex] == NOT_IN_MESHLET && !repeated) {
+                ++newVertexCount;
+            }
+        }
+        if (meshletVertices.size() - vertexOffset + newVertexCount > MAX_MESHLET_VERTICES
+            || meshletTriangles.size() / 3 - triangleOffset + 1 > MAX_MESHLET_TRIANGLES) {
+            flushMeshlet();
+        }
+
+        for (size_t k = 0; k < 3; ++k) {
+            const uint32_t vertex = indices[i + k];
+            if (localIndices[vertex] == NOT_IN_MESHLET) {
+                localIndices[vertex] = static_cast<uint8_t>(meshletVertices.size() - vertexOffset);
+                meshletVertices.push_back(vertex);
+            }
+            meshletTriangles.push_back(localIndices[vertex]);
+        }
+    }
+    flushMeshlet();
+}
@@ -0,0 +1,45 @@
+// Copyright (c) 2025 SolverX Corporation
+// This file is part of MIE OpenCascade WebAssembly Bindings.
+//
+// This library is free software; you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License version 2.1 as published
+// by the Free Software Foundation.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// index buffer post-processing. indices reference the vertex range [vertexBase, vertexBase + vertexCount).
+class MeshOptimizer {
+public:
+    // reorders triangles for post-transform vertex cache hits (Forsyth's linear-speed vertex cache optimization)
+    static void optimizeVertexCache(uint32_t* indices, size_t indexCount, uint32_t vertexBase, size_t vertexCount);
+
+    // renumbers vertices in order of first use, so that vertex fetches walk memory forward.
+    // writes the new index of each vertex, relative to vertexBase, to remap (unused vertices are moved last).
+    // indices outside the vertex range are skipped and indices are left as is, so the caller applies remap.
+    static void buildVertexFetchRemap(const uint32_t* indices, size_t indexCount, uint32_t vertexBase, size_t vertexCount, uint32_t* remap);
+
+    static constexpr size_t MAX_MESHLET_VERTICES = 64;
+    static constexpr size_t MAX_MESHLET_TRIANGLES = 124;
+    static constexpr size_t MESHLET_STRIDE = 4; // vertex offset, triangle offset, vertex count, triangle count
+    static constexpr size_t MESHLET_BOUNDS_STRIDE = 8; // sphere center xyz, radius, cone axis xyz, cone cutoff
+
+    // splits the triangles, in index order, into meshlets of at most MAX_MESHLET_VERTICES and MAX_MESHLET_TRIANGLES.
+    // meshletVertices receives the vertex indices of each meshlet and meshletTriangles their local triangle indices.
+    // the cone cutoff is the sine of the normal cone half angle, 1 when the meshlet can not be backface culled.
+    // positions are read at vertex * positionStride floats.
+    static void buildMeshlets(
+        const uint32_t* indices,
+        size_t indexCount,
+        const float* positions,
+        size_t positionStride,
+        size_t vertexCount,
+        std::vector<uint32_t>& meshlets,
+        std::vector<uint32_t>& meshletVertices,
+        std::vector<uint8_t>& meshletTriangles,
+        std::vector<float>& meshletBounds
+    );
+};
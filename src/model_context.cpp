@@ -9,15 +9,162 @@
 
 #include <emscripten/bind.h>
 
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <type_traits>
 #include <utility>
+
+#include "content_hash.hpp"
+#include "mesh_optimizer.hpp"
+#include "model_glb_export.hpp"
+#include "model_raycaster.hpp"
+#include "model_serialization.hpp"
+#include "model_triangulation_impl.hpp"
+#include "triangulation_cache.hpp"
 #ifdef __EMSCRIPTEN_PTHREADS__
-#include <thread>
+#include "task_scheduler.hpp"
 #endif
 
-#include "model_triangulation_impl.hpp"
+namespace {
+
+void expandBounds(Bounds& bounds, const Bounds& other) {
+    for (size_t axis = 0; axis < 3; ++axis) {
+        bounds[axis] = std::min(bounds[axis], other[axis]);
+        bounds[axis + 3] = std::max(bounds[axis + 3], other[axis + 3]);
+    }
+}
+
+// bounds of the box corners transformed by a column-major matrix
+Bounds transformBounds(const Bounds& bounds, const std::array<float, 16>& m) {
+    Bounds result = EMPTY_BOUNDS;
+    if (bounds[0] > bounds[3]) {
+        return result;
+    }
+    for (int corner = 0; corner < 8; ++corner) {
+        const float x = bounds[(corner & 1) ? 3 : 0];
+        const float y = bounds[(corner & 2) ? 4 : 1];
+        const float z = bounds[(corner & 4) ? 5 : 2];
+        const float tx = m[0] * x + m[4] * y + m[8] * z + m[12];
+        const float ty = m[1] * x + m[5] * y + m[9] * z + m[13];
+        const float tz = m[2] * x + m[6] * y + m[10] * z + m[14];
+        expandBounds(result, { tx, ty, tz, tx, ty, tz });
+    }
+    return result;
+}
+
+} // namespace
 
 // TriGeometry methods
 
+size_t TriGeometry::getVertexCount() const {
+    switch (layout) {
+    case VertexLayout::Interleaved: return vertices.size() / INTERLEAVED_STRIDE;
+    case VertexLayout::Quantized: return quantizedVertices.size() / QUANTIZED_STRIDE;
+    default: return positions.size() / 3;
+    }
+}
+
+size_t TriGeometry::getIndexCount() const {
+    return indexFormat == IndexFormat::Uint16 ? indices16.size() : indices.size();
+}
+
+std::array<float, 3> TriGeometry::getVertexPosition(size_t vertex) const {
+    switch (layout) {
+    case VertexLayout::Interleaved: {
+        const float* position = vertices.data() + vertex * INTERLEAVED_STRIDE + INTERLEAVED_POSITION_OFFSET;
+        return { position[0], position[1], position[2] };
+    }
+    case VertexLayout::Quantized: {
+        // the dequantization matrix only scales and translates
+        const uint16_t* position = quantizedVertices.data() + vertex * QUANTIZED_STRIDE + QUANTIZED_POSITION_OFFSET;
+        return {
+            dequantizationMatrix[12] + dequantizationMatrix[0] * (static_cast<float>(position[0]) / 65535.0f),
+            dequantizationMatrix[13] + dequantizationMatrix[5] * (static_cast<float>(position[1]) / 65535.0f),
+            dequantizationMatrix[14] + dequantizationMatrix[10] * (static_cast<float>(position[2]) / 65535.0f)
+        };
+    }
+    default: {
+        const float* position = positions.data() + vertex * 3;
+        return { position[0], position[1], position[2] };
+    }
+    }
+}
+
+std::array<float, 3> TriGeometry::getVertexNormal(size_t vertex) const {
+    switch (layout) {
+    case VertexLayout::Interleaved: {
+        const float* normal = vertices.data() + vertex * INTERLEAVED_STRIDE + INTERLEAVED_NORMAL_OFFSET;
+        return { normal[0], normal[1], normal[2] };
+    }
+    case VertexLayout::Quantized: {
+        // octahedral decoding
+        const uint16_t* normal = quantizedVertices.data() + vertex * QUANTIZED_STRIDE + QUANTIZED_NORMAL_OFFSET;
+        float x = std::max(static_cast<float>(static_cast<int16_t>(normal[0])) / 32767.0f, -1.0f);
+        float y = std::max(static_cast<float>(static_cast<int16_t>(normal[1])) / 32767.0f, -1.0f);
+        const float z = 1.0f - std::abs(x) - std::abs(y);
+        if (z < 0.0f) {
+            const float foldedX = (1.0f - std::abs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+            const float foldedY = (1.0f - std::abs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+            x = foldedX;
+            y = foldedY;
+        }
+        const float length = std::sqrt(x * x + y * y + z * z);
+        return { x / length, y / length, z / length };
+    }
+    default: {
+        const float* normal = normals.data() + vertex * 3;
+        return { normal[0], normal[1], normal[2] };
+    }
+    }
+}
+
+std::array<float, 2> TriGeometry::getVertexUV(size_t vertex) const {
+    switch (layout) {
+    case VertexLayout::Interleaved: {
+        const float* uv = vertices.data() + vertex * INTERLEAVED_STRIDE + INTERLEAVED_UV_OFFSET;
+        return { uv[0], uv[1] };
+    }
+    case VertexLayout::Quantized: {
+        const uint16_t* uv = quantizedVertices.data() + vertex * QUANTIZED_STRIDE + QUANTIZED_UV_OFFSET;
+        return { static_cast<float>(uv[0]) / 65535.0f, static_cast<float>(uv[1]) / 65535.0f };
+    }
+    default: {
+        const float* uv = uvs.data() + vertex * 2;
+        return { uv[0], uv[1] };
+    }
+    }
+}
+
+void TriGeometry::remapVertices(const std::vector<uint32_t>& remap, size_t newVertexCount) {
+    auto remapAttribute = [&remap, newVertexCount](auto& values, size_t componentCount) {
+        std::remove_reference_t<decltype(values)> remapped(newVertexCount * componentCount);
+        // backwards, so that the first of merged vertices is written last
+        for (size_t i = remap.size(); i-- > 0;) {
+            std::copy_n(values.begin() + i * componentCount, componentCount, remapped.begin() + remap[i] * componentCount);
+        }
+        values.swap(remapped);
+    };
+
+    switch (layout) {
+    case VertexLayout::Interleaved:
+        remapAttribute(vertices, INTERLEAVED_STRIDE);
+        break;
+    case VertexLayout::Quantized:
+        remapAttribute(quantizedVertices, QUANTIZED_STRIDE);
+        break;
+    default:
+        remapAttribute(positions, 3);
+        remapAttribute(normals, 3);
+        remapAttribute(uvs, 2);
+        break;
+    }
+}
+
+VertexLayout TriGeometry::getLayout() const {
+    return layout;
+}
+
 Float32Array TriGeometry::getPositions() const {
     emscripten::memory_view view(positions.size(), reinterpret_cast<const float*>(positions.data()));
     return Float32Array(emscripten::val(view));
@@ -33,16 +180,95 @@ Float32Array TriGeometry::getUVs() const {
     return Float32Array(emscripten::val(view));
 }
 
+Float32Array TriGeometry::getVertices() const {
+    emscripten::memory_view view(vertices.size(), reinterpret_cast<const float*>(vertices.data()));
+    return Float32Array(emscripten::val(view));
+}
+
+Uint16Array TriGeometry::getQuantizedVertices() const {
+    emscripten::memory_view view(quantizedVertices.size(), reinterpret_cast<const uint16_t*>(quantizedVertices.data()));
+    return Uint16Array(emscripten::val(view));
+}
+
+Float32Array TriGeometry::getDequantizationMatrix() const {
+    emscripten::memory_view view(16, reinterpret_cast<const float*>(dequantizationMatrix.data()));
+    return Float32Array(emscripten::val(view));
+}
+
+size_t TriGeometry::getVertexStride() const {
+    return layout == VertexLayout::Quantized ? QUANTIZED_STRIDE * sizeof(uint16_t) : INTERLEAVED_STRIDE * sizeof(float);
+}
+
+size_t TriGeometry::getPositionOffset() const {
+    return layout == VertexLayout::Quantized ? QUANTIZED_POSITION_OFFSET * sizeof(uint16_t) : INTERLEAVED_POSITION_OFFSET * sizeof(float);
+}
+
+size_t TriGeometry::getNormalOffset() const {
+    return layout == VertexLayout::Quantized ? QUANTIZED_NORMAL_OFFSET * sizeof(uint16_t) : INTERLEAVED_NORMAL_OFFSET * sizeof(float);
+}
+
+size_t TriGeometry::getUVOffset() const {
+    return layout == VertexLayout::Quantized ? QUANTIZED_UV_OFFSET * sizeof(uint16_t) : INTERLEAVED_UV_OFFSET * sizeof(float);
+}
+
+IndexFormat TriGeometry::getIndexFormat() const {
+    return indexFormat;
+}
+
 Uint32Array TriGeometry::getIndices() const {
     emscripten::memory_view view(indices.size(), reinterpret_cast<const uint32_t*>(indices.data()));
     return Uint32Array(emscripten::val(view));
 }
 
+Uint16Array TriGeometry::getIndices16() const {
+    emscripten::memory_view view(indices16.size(), reinterpret_cast<const uint16_t*>(indices16.data()));
+    return Uint16Array(emscripten::val(view));
+}
+
 Uint32Array TriGeometry::getSubMeshIndices() const {
     emscripten::memory_view view(subMeshIndices.size(), reinterpret_cast<const uint32_t*>(subMeshIndices.data()));
     return Uint32Array(emscripten::val(view));
 }
 
+Uint32Array TriGeometry::getSubMeshIndexCounts() const {
+    emscripten::memory_view view(subMeshIndexCounts.size(), reinterpret_cast<const uint32_t*>(subMeshIndexCounts.data()));
+    return Uint32Array(emscripten::val(view));
+}
+
+size_t TriGeometry::getMeshletCount() const {
+    return meshlets.size() / MeshOptimizer::MESHLET_STRIDE;
+}
+
+Uint32Array TriGeometry::getMeshlets() const {
+    emscripten::memory_view view(meshlets.size(), reinterpret_cast<const uint32_t*>(meshlets.data()));
+    return Uint32Array(emscripten::val(view));
+}
+
+Uint32Array TriGeometry::getMeshletVertices() const {
+    emscripten::memory_view view(meshletVertices.size(), reinterpret_cast<const uint32_t*>(meshletVertices.data()));
+    return Uint32Array(emscripten::val(view));
+}
+
+Uint8Array TriGeometry::getMeshletTriangles() const {
+    emscripten::memory_view view(meshletTriangles.size(), reinterpret_cast<const uint8_t*>(meshletTriangles.data()));
+    return Uint8Array(emscripten::val(view));
+}
+
+Float32Array TriGeometry::getMeshletBounds() const {
+    emscripten::memory_view view(meshletBounds.size(), reinterpret_cast<const float*>(meshletBounds.data()));
+    return Float32Array(emscripten::val(view));
+}
+
+Float32Array TriGeometry::getBounds() const {
+    emscripten::memory_view view(6, reinterpret_cast<const float*>(bounds.data()));
+    return Float32Array(emscripten::val(view));
+}
+
+Float32Array TriGeometry::getBoundingSphere() const {
+    emscripten::memory_view view(4, reinterpret_cast<const float*>(boundingSphere.data()));
+    return Float32Array(emscripten::val(view));
+}
+
 // LineGeometry methods
 
 Float32Array LineGeometry::getPositions() const {
@@ -55,6 +281,16 @@ Uint32Array LineGeometry::getSubMeshIndices() const {
     return Uint32Array(emscripten::val(view));
 }
 
+Float32Array LineGeometry::getBounds() const {
+    emscripten::memory_view view(6, reinterpret_cast<const float*>(bounds.data()));
+    return Float32Array(emscripten::val(view));
+}
+
+Float32Array LineGeometry::getBoundingSphere() const {
+    emscripten::memory_view view(4, reinterpret_cast<const float*>(boundingSphere.data()));
+    return Float32Array(emscripten::val(view));
+}
+
 // PointGeometry methods
 
 Float32Array PointGeometry::getPositions() const {
@@ -62,6 +298,16 @@ Float32Array PointGeometry::getPositions() const {
     return Float32Array(emscripten::val(view));
 }
 
+Float32Array PointGeometry::getBounds() const {
+    emscripten::memory_view view(6, reinterpret_cast<const float*>(bounds.data()));
+    return Float32Array(emscripten::val(view));
+}
+
+Float32Array PointGeometry::getBoundingSphere() const {
+    emscripten::memory_view view(4, reinterpret_cast<const float*>(boundingSphere.data()));
+    return Float32Array(emscripten::val(view));
+}
+
 // Material methods
 
 Float32Array Material::getColor() const {
@@ -80,6 +326,16 @@ Float32Array Mesh::getTransform() const {
     return Float32Array(emscripten::val(view));
 }
 
+Float32Array Mesh::getWorldTransform() const {
+    emscripten::memory_view view(16, reinterpret_cast<const float*>(worldTransform.data()));
+    return Float32Array(emscripten::val(view));
+}
+
+Float32Array Mesh::getWorldBounds() const {
+    emscripten::memory_view view(6, reinterpret_cast<const float*>(worldBounds.data()));
+    return Float32Array(emscripten::val(view));
+}
+
 MeshShapeType Mesh::getShapeType() const {
     return shapeType;
 }
@@ -104,8 +360,100 @@ int Mesh::getParentMeshIndex() const {
     return parentMeshIndex;
 }
 
+void Mesh::expandWorldBounds(const Bounds& other) {
+    expandBounds(worldBounds, other);
+}
+
+// MaterialBatch methods
+
+int MaterialBatch::getMaterialIndex() const {
+    return materialIndex;
+}
+
+size_t MaterialBatch::getMeshCount() const {
+    return meshRanges.size() / MESH_RANGE_STRIDE;
+}
+
+Float32Array MaterialBatch::getPositions() const {
+    emscripten::memory_view view(positions.size(), reinterpret_cast<const float*>(positions.data()));
+    return Float32Array(emscripten::val(view));
+}
+
+Float32Array MaterialBatch::getNormals() const {
+    emscripten::memory_view view(normals.size(), reinterpret_cast<const float*>(normals.data()));
+    return Float32Array(emscripten::val(view));
+}
+
+Float32Array MaterialBatch::getUVs() const {
+    emscripten::memory_view view(uvs.size(), reinterpret_cast<const float*>(uvs.data()));
+    return Float32Array(emscripten::val(view));
+}
+
+Uint32Array MaterialBatch::getIndices() const {
+    emscripten::memory_view view(indices.size(), reinterpret_cast<const uint32_t*>(indices.data()));
+    return Uint32Array(emscripten::val(view));
+}
+
+Uint32Array MaterialBatch::getMeshRanges() const {
+    emscripten::memory_view view(meshRanges.size(), reinterpret_cast<const uint32_t*>(meshRanges.data()));
+    return Uint32Array(emscripten::val(view));
+}
+
 // TriangulatedModel methods
 
+void TriangulatedModel::buildTriInstances() {
+    // counting sort of the meshes by tri geometry
+    triInstanceOffsets.assign(tris.size() + 1, 0);
+    for (const Mesh& mesh : meshes) {
+        if (mesh.getTriGeometryIndex() >= 0) {
+            ++triInstanceOffsets[mesh.getTriGeometryIndex() + 1];
+        }
+    }
+    for (size_t i = 1; i < triInstanceOffsets.size(); ++i) {
+        triInstanceOffsets[i] += triInstanceOffsets[i - 1];
+    }
+
+    const size_t instanceCount = triInstanceOffsets.back();
+    triInstanceMeshIndices.resize(instanceCount);
+    triInstanceTransforms.resize(instanceCount * 16);
+    std::vector<uint32_t> next(triInstanceOffsets.begin(), triInstanceOffsets.end() - 1);
+    for (size_t meshIndex = 0; meshIndex < meshes.size(); ++meshIndex) {
+        const int triGeometryIndex = meshes[meshIndex].getTriGeometryIndex();
+        if (triGeometryIndex < 0) {
+            continue;
+        }
+        const uint32_t instance = next[triGeometryIndex]++;
+        triInstanceMeshIndices[instance] = static_cast<uint32_t>(meshIndex);
+        const std::array<float, 16>& worldTransform = meshes[meshIndex].getWorldTransformData();
+        std::copy(worldTransform.begin(), worldTransform.end(), triInstanceTransforms.begin() + instance * 16);
+    }
+}
+
+void TriangulatedModel::buildMeshTable() {
+    const size_t meshCount = meshes.size();
+    meshParentIndices.resize(meshCount);
+    meshTriGeometryIndices.resize(meshCount);
+    meshLineGeometryIndices.resize(meshCount);
+    meshPointGeometryIndices.resize(meshCount);
+    meshMaterialIndices.resize(meshCount);
+    meshShapeTypes.resize(meshCount);
+    meshTransforms.resize(meshCount * 16);
+    meshWorldTransforms.resize(meshCount * 16);
+    meshWorldBounds.resize(meshCount * 6);
+    for (size_t i = 0; i < meshCount; ++i) {
+        const Mesh& mesh = meshes[i];
+        meshParentIndices[i] = mesh.getParentMeshIndex();
+        meshTriGeometryIndices[i] = mesh.getTriGeometryIndex();
+        meshLineGeometryIndices[i] = mesh.getLineGeometryIndex();
+        meshPointGeometryIndices[i] = mesh.getPointGeometryIndex();
+        meshMaterialIndices[i] = mesh.getMaterialIndex();
+        meshShapeTypes[i] = static_cast<uint8_t>(mesh.getShapeType());
+        std::copy(mesh.getTransformData().begin(), mesh.getTransformData().end(), meshTransforms.begin() + i * 16);
+        std::copy(mesh.getWorldTransformData().begin(), mesh.getWorldTransformData().end(), meshWorldTransforms.begin() + i * 16);
+        std::copy(mesh.getWorldBoundsData().begin(), mesh.getWorldBoundsData().end(), meshWorldBounds.begin() + i * 6);
+    }
+}
+
 size_t TriangulatedModel::getTriCount() const {
     return tris.size();
 }
@@ -146,26 +494,317 @@ Mesh& TriangulatedModel::getMesh(size_t index) {
     return meshes[index];
 }
 
+Int32Array TriangulatedModel::getMeshParentIndices() const {
+    emscripten::memory_view view(meshParentIndices.size(), reinterpret_cast<const int32_t*>(meshParentIndices.data()));
+    return Int32Array(emscripten::val(view));
+}
+
+Int32Array TriangulatedModel::getMeshTriGeometryIndices() const {
+    emscripten::memory_view view(meshTriGeometryIndices.size(), reinterpret_cast<const int32_t*>(meshTriGeometryIndices.data()));
+    return Int32Array(emscripten::val(view));
+}
+
+Int32Array TriangulatedModel::getMeshLineGeometryIndices() const {
+    emscripten::memory_view view(meshLineGeometryIndices.size(), reinterpret_cast<const int32_t*>(meshLineGeometryIndices.data()));
+    return Int32Array(emscripten::val(view));
+}
+
+Int32Array TriangulatedModel::getMeshPointGeometryIndices() const {
+    emscripten::memory_view view(meshPointGeometryIndices.size(), reinterpret_cast<const int32_t*>(meshPointGeometryIndices.data()));
+    return Int32Array(emscripten::val(view));
+}
+
+Int32Array TriangulatedModel::getMeshMaterialIndices() const {
+    emscripten::memory_view view(meshMaterialIndices.size(), reinterpret_cast<const int32_t*>(meshMaterialIndices.data()));
+    return Int32Array(emscripten::val(view));
+}
+
+Uint8Array TriangulatedModel::getMeshShapeTypes() const {
+    emscripten::memory_view view(meshShapeTypes.size(), reinterpret_cast<const uint8_t*>(meshShapeTypes.data()));
+    return Uint8Array(emscripten::val(view));
+}
+
+Float32Array TriangulatedModel::getMeshTransforms() const {
+    emscripten::memory_view view(meshTransforms.size(), reinterpret_cast<const float*>(meshTransforms.data()));
+    return Float32Array(emscripten::val(view));
+}
+
+Float32Array TriangulatedModel::getMeshWorldTransforms() const {
+    emscripten::memory_view view(meshWorldTransforms.size(), reinterpret_cast<const float*>(meshWorldTransforms.data()));
+    return Float32Array(emscripten::val(view));
+}
+
+Float32Array TriangulatedModel::getMeshWorldBounds() const {
+    emscripten::memory_view view(meshWorldBounds.size(), reinterpret_cast<const float*>(meshWorldBounds.data()));
+    return Float32Array(emscripten::val(view));
+}
+
+Float32Array TriangulatedModel::getBounds() const {
+    emscripten::memory_view view(6, reinterpret_cast<const float*>(bounds.data()));
+    return Float32Array(emscripten::val(view));
+}
+
+size_t TriangulatedModel::getLodCount() const {
+    return lodCount;
+}
+
+TriGeometry& TriangulatedModel::getTriLod(size_t index, size_t level) {
+    if (level == 0) {
+        return tris[index];
+    }
+    return lodTris[index * (lodCount - 1) + (level - 1)];
+}
+
+size_t TriangulatedModel::getTriInstanceCount(size_t index) const {
+    return triInstanceOffsets[index + 1] - triInstanceOffsets[index];
+}
+
+Uint32Array TriangulatedModel::getTriInstanceMeshIndices(size_t index) const {
+    emscripten::memory_view view(getTriInstanceCount(index), reinterpret_cast<const uint32_t*>(triInstanceMeshIndices.data() + triInstanceOffsets[index]));
+    return Uint32Array(emscripten::val(view));
+}
+
+Float32Array TriangulatedModel::getTriInstanceTransforms(size_t index) const {
+    emscripten::memory_view view(getTriInstanceCount(index) * 16, reinterpret_cast<const float*>(triInstanceTransforms.data() + triInstanceOffsets[index] * 16));
+    return Float32Array(emscripten::val(view));
+}
+
+size_t TriangulatedModel::getMaterialBatchCount() const {
+    return materialBatches.size();
+}
+
+MaterialBatch& TriangulatedModel::getMaterialBatch(size_t index) {
+    return materialBatches[index];
+}
+
+ByteBuffer TriangulatedModel::toGLB() {
+    return ModelGlbExport::write(*this);
+}
+
+ByteBuffer TriangulatedModel::toTriangulatedCache() {
+    return ModelSerialization::write(*this);
+}
+
+std::optional<TriangulatedModel> TriangulatedModel::fromTriangulatedCache(const Uint8Array& buffer) {
+    const std::vector<uint8_t> data = emscripten::convertJSArrayToNumberVector<uint8_t>(buffer);
+    return ModelSerialization::read(data.data(), data.size());
+}
+
+std::optional<TriangulatedModel> TriangulatedModel::fromTriangulatedCacheBuffer(const ByteBuffer& buffer) {
+    return ModelSerialization::read(buffer.getData(), buffer.getSize());
+}
+
+void TriangulatedModel::setTri(size_t index, TriGeometry&& geometry) {
+    tris[index] = std::move(geometry);
+}
+
+void TriangulatedModel::updateModelBounds() {
+    bounds = EMPTY_BOUNDS;
+    for (const Mesh& mesh : meshes) {
+        if (mesh.getParentMeshIndex() < 0) {
+            expandBounds(bounds, mesh.getWorldBoundsData());
+        }
+    }
+}
+
+void TriangulatedModel::updateBounds() {
+    for (Mesh& mesh : meshes) {
+        const std::array<float, 16>& worldTransform = mesh.getWorldTransformData();
+        Bounds meshBounds = EMPTY_BOUNDS;
+        if (mesh.getTriGeometryIndex() >= 0) {
+            expandBounds(meshBounds, transformBounds(tris[mesh.getTriGeometryIndex()].bounds, worldTransform));
+        }
+        if (mesh.getLineGeometryIndex() >= 0) {
+            expandBounds(meshBounds, transformBounds(lines[mesh.getLineGeometryIndex()].bounds, worldTransform));
+        }
+        if (mesh.getPointGeometryIndex() >= 0) {
+            expandBounds(meshBounds, transformBounds(points[mesh.getPointGeometryIndex()].bounds, worldTransform));
+        }
+        mesh.setWorldBounds(meshBounds);
+    }
+    // children follow their parents, so each mesh is complete before it is added to its parent
+    for (size_t i = meshes.size(); i-- > 0;) {
+        const int parentMeshIndex = meshes[i].getParentMeshIndex();
+        if (parentMeshIndex >= 0) {
+            meshes[parentMeshIndex].expandWorldBounds(meshes[i].getWorldBoundsData());
+        }
+    }
+    for (size_t i = 0; i < meshes.size(); ++i) {
+        const Bounds& meshBounds = meshes[i].getWorldBoundsData();
+        std::copy(meshBounds.begin(), meshBounds.end(), meshWorldBounds.begin() + i * 6);
+    }
+    updateModelBounds();
+}
+
 // ModelContext methods
 
-void ModelContext::computeTriangulation() {
+bool ModelContext::computeTriangulationInternal(const TriangulationOptions& options, const Handle(TaskProgress)& progress) {
 #ifdef __EMSCRIPTEN_PTHREADS__
     std::lock_guard<std::mutex> lock(triangulationMutex);
 #endif
 
-    if (triangulatedModel.has_value()) {
-        return;
+    if (triangulatedModel.has_value() && triangulationOptions == options) {
+        return true;
     }
 
-    triangulatedModel = ModelTriangulationImpl::computeTriangulation(shapeTool, colorTool);
+#ifdef __EMSCRIPTEN_PTHREADS__
+    beginModelReplacement(nullptr);
+#endif
+
+    // stays empty when cancelled, so that a later call starts over
+    raycaster.reset();
+    triangulatedModel.reset();
+    triangulatedModel = ModelTriangulationImpl::computeTriangulation(shapeTool, colorTool, options, progress, nullptr, triangulationCache);
+    triangulationOptions = options;
+    return triangulatedModel.has_value();
+}
+
+void ModelContext::computeTriangulation() {
+    computeTriangulationInternal(TriangulationOptions(), new TaskProgress());
+}
+
+void ModelContext::computeTriangulationWithOptions(const TriangulationOptions& options) {
+    computeTriangulationInternal(options, new TaskProgress());
 }
 
 #ifdef __EMSCRIPTEN_PTHREADS__
-void ModelContext::computeTriangulationAsync(TriangulationAsyncTask& task) {
-    std::thread([this, &task]() {
-        computeTriangulation();
-        task.setValue(triangulatedModel.has_value() ? true : false);
-    }).detach();
+uint64_t ModelContext::beginModelReplacement(const Handle(TaskProgress)& nextRefinementProgress) {
+    uint64_t generation;
+    {
+        std::lock_guard<std::mutex> refinementLock(refinementMutex);
+        if (!refinementProgress.IsNull()) {
+            refinementProgress->cancel();
+        }
+        refinementProgress = nextRefinementProgress;
+        // drop geometries refined for the previous model
+        pendingRefinements.clear();
+        generation = ++modelGeneration;
+    }
+    // BRepMesh stops at the next face once cancelled
+    std::lock_guard<std::mutex> refiningLock(refiningMutex);
+    return generation;
+}
+
+emscripten::val ModelContext::computeTriangulationAsync(TriangulationAsyncTask& task) {
+    return computeTriangulationAsyncWithPriority(task, TaskPriority::Normal);
+}
+
+emscripten::val ModelContext::computeTriangulationAsyncWithPriority(TriangulationAsyncTask& task, TaskPriority priority) {
+    return computeTriangulationAsyncWithOptions(task, priority, TriangulationOptions());
+}
+
+emscripten::val ModelContext::computeTriangulationAsyncWithOptions(TriangulationAsyncTask& task, TaskPriority priority, const TriangulationOptions& options) {
+    emscripten::val promise = task.createPromise();
+    TaskScheduler::instance().submit([this, &task, options]() {
+        // the promise resolves with whether a value was set
+        if (computeTriangulationInternal(options, task.getProgressIndicator())) {
+            task.setValue(true);
+        } else {
+            task.setValue(std::nullopt);
+        }
+    }, priority);
+    return promise;
+}
+
+emscripten::val ModelContext::computeTriangulationProgressiveAsync(
+    TriangulationAsyncTask& coarseTask,
+    TriangulationAsyncTask& refineTask,
+    TaskPriority priority,
+    const TriangulationOptions& options
+) {
+    // coarse enough to show the whole model within a fraction of the fine meshing time
+    constexpr double COARSE_DEFLECTION_SCALE = 16.0;
+    constexpr double COARSE_MAXIMAL_ANGLE_DEFLECTION = 0.8;
+
+    TriangulationOptions fineOptions = options;
+    fineOptions.lodCount = 1;
+    TriangulationOptions coarseOptions = fineOptions;
+    coarseOptions.linearDeflection *= COARSE_DEFLECTION_SCALE;
+    coarseOptions.angularDeflection = std::min(options.angularDeflection * COARSE_DEFLECTION_SCALE, COARSE_MAXIMAL_ANGLE_DEFLECTION);
+    coarseOptions.minSize *= COARSE_DEFLECTION_SCALE;
+
+    emscripten::val result = emscripten::val::object();
+    result.set("coarse", coarseTask.createPromise());
+    result.set("refined", refineTask.createPromise());
+    if (options.mergeByMaterial) {
+        // material batches are built from the coarse geometries and would not follow the refinement
+        std::cerr << "Triangulation error: mergeByMaterial is not supported by the progressive triangulation" << std::endl;
+        coarseTask.setValue(std::nullopt);
+        refineTask.setValue(std::nullopt);
+        return result;
+    }
+    TaskScheduler::instance().submit([this, &coarseTask, &refineTask, coarseOptions, fineOptions]() {
+        std::vector<TopoDS_Shape> triGeometryShapes;
+        uint64_t generation;
+        bool computed;
+        {
+            // only held until the coarse model is published, refined geometries are tagged with its generation
+            std::lock_guard<std::mutex> lock(triangulationMutex);
+            generation = beginModelReplacement(refineTask.getProgressIndicator());
+            raycaster.reset();
+            triangulatedModel.reset();
+            triangulatedModel = ModelTriangulationImpl::computeTriangulation(
+                shapeTool, colorTool, coarseOptions, coarseTask.getProgressIndicator(), &triGeometryShapes, triangulationCache);
+            triangulationOptions = coarseOptions;
+            computed = triangulatedModel.has_value();
+        }
+        // the promises resolve with whether a value was set
+        if (!computed) {
+            coarseTask.setValue(std::nullopt);
+            refineTask.setValue(std::nullopt);
+            return;
+        }
+        coarseTask.setValue(true);
+
+        bool refined;
+        {
+            std::lock_guard<std::mutex> refiningLock(refiningMutex);
+            refined = ModelTriangulationImpl::refineTriangulation(
+                triGeometryShapes, fineOptions, refineTask.getProgressIndicator(),
+                [this, generation](size_t index, TriGeometry&& geometry) {
+                    std::lock_guard<std::mutex> refinementLock(refinementMutex);
+                    if (modelGeneration == generation) {
+                        pendingRefinements.emplace_back(index, std::move(geometry));
+                    }
+                }, triangulationCache);
+        }
+        if (refined) {
+            std::lock_guard<std::mutex> lock(triangulationMutex);
+            std::lock_guard<std::mutex> refinementLock(refinementMutex);
+            if (modelGeneration == generation) {
+                // complete once the pending geometries are applied
+                triangulationOptions = fineOptions;
+                refinementProgress.Nullify();
+            } else {
+                refined = false;
+            }
+        }
+        refineTask.setValue(refined ? std::optional<bool>(true) : std::nullopt);
+    }, priority);
+    return result;
+}
+
+Uint32Array ModelContext::applyRefinements() {
+    refinedTriIndices.clear();
+    // not while a model is being computed: it replaces this one and drops the pending geometries
+    std::unique_lock<std::mutex> lock(triangulationMutex, std::try_to_lock);
+    if (lock.owns_lock() && triangulatedModel.has_value()) {
+        std::vector<std::pair<size_t, TriGeometry>> refinements;
+        {
+            std::lock_guard<std::mutex> refinementLock(refinementMutex);
+            refinements.swap(pendingRefinements);
+        }
+        for (auto& [index, geometry] : refinements) {
+            triangulatedModel->setTri(index, std::move(geometry));
+            refinedTriIndices.push_back(static_cast<uint32_t>(index));
+        }
+    }
+    if (!refinedTriIndices.empty()) {
+        triangulatedModel->updateBounds();
+        raycaster.reset();
+    }
+    emscripten::memory_view view(refinedTriIndices.size(), reinterpret_cast<const uint32_t*>(refinedTriIndices.data()));
+    return Uint32Array(emscripten::val(view));
 }
 #endif
 
@@ -173,20 +812,99 @@ std::optional<TriangulatedModel>& ModelContext::getTriangulatedModel() {
     return triangulatedModel;
 }
 
+void ModelContext::setContentHash(uint64_t hash) {
+    contentHash = hash;
+}
+
+std::string ModelContext::getContentHash() const {
+    return contentHash.has_value() ? ContentHasher::toHex(*contentHash) : std::string();
+}
+
+void ModelContext::setTriangulationCache(TriangulationCache* cache) {
+    triangulationCache = cache;
+}
+
+ModelRaycaster* ModelContext::getRaycaster() {
+    if (!triangulatedModel.has_value()) {
+        return nullptr;
+    }
+    if (!raycaster) {
+        raycaster = std::make_shared<ModelRaycaster>(*triangulatedModel);
+    }
+    return raycaster.get();
+}
+
+std::optional<RaycastHit> ModelContext::raycast(float originX, float originY, float originZ, float directionX, float directionY, float directionZ) {
+    ModelRaycaster* modelRaycaster = getRaycaster();
+    if (modelRaycaster == nullptr) {
+        return std::nullopt;
+    }
+    return modelRaycaster->raycast(
+        { originX, originY, originZ },
+        { directionX, directionY, directionZ },
+        std::numeric_limits<float>::max());
+}
+
+RaycastBatch ModelContext::raycastMany(const Float32Array& origins, const Float32Array& directions) {
+    const std::vector<float> originData = emscripten::convertJSArrayToNumberVector<float>(origins);
+    const std::vector<float> directionData = emscripten::convertJSArrayToNumberVector<float>(directions);
+    const size_t rayCount = std::min(originData.size(), directionData.size()) / 3;
+
+    RaycastBatch batch(rayCount);
+    ModelRaycaster* modelRaycaster = getRaycaster();
+    if (modelRaycaster != nullptr) {
+        modelRaycaster->raycastMany(originData.data(), directionData.data(), rayCount, batch);
+    }
+    return batch;
+}
+
 EMSCRIPTEN_BINDINGS(model_context_module) {
+    emscripten::enum_<VertexLayout>("VertexLayout")
+        .value("Separate", VertexLayout::Separate)
+        .value("Interleaved", VertexLayout::Interleaved)
+        .value("Quantized", VertexLayout::Quantized);
+
+    emscripten::enum_<IndexFormat>("IndexFormat")
+        .value("Uint32", IndexFormat::Uint32)
+        .value("Uint16", IndexFormat::Uint16);
+
     emscripten::class_<TriGeometry>("TriGeometry")
+        .function("getVertexCount", &TriGeometry::getVertexCount)
+        .function("getIndexCount", &TriGeometry::getIndexCount)
+        .function("getLayout", &TriGeometry::getLayout)
         .function("getPositions", &TriGeometry::getPositions)
         .function("getNormals", &TriGeometry::getNormals)
         .function("getUVs", &TriGeometry::getUVs)
+        .function("getVertices", &TriGeometry::getVertices)
+        .function("getQuantizedVertices", &TriGeometry::getQuantizedVertices)
+        .function("getDequantizationMatrix", &TriGeometry::getDequantizationMatrix)
+        .function("getVertexStride", &TriGeometry::getVertexStride)
+        .function("getPositionOffset", &TriGeometry::getPositionOffset)
+        .function("getNormalOffset", &TriGeometry::getNormalOffset)
+        .function("getUVOffset", &TriGeometry::getUVOffset)
+        .function("getIndexFormat", &TriGeometry::getIndexFormat)
         .function("getIndices", &TriGeometry::getIndices)
-        .function("getSubMeshIndices", &TriGeometry::getSubMeshIndices);
+        .function("getIndices16", &TriGeometry::getIndices16)
+        .function("getSubMeshIndices", &TriGeometry::getSubMeshIndices)
+        .function("getSubMeshIndexCounts", &TriGeometry::getSubMeshIndexCounts)
+        .function("getMeshletCount", &TriGeometry::getMeshletCount)
+        .function("getMeshlets", &TriGeometry::getMeshlets)
+        .function("getMeshletVertices", &TriGeometry::getMeshletVertices)
+        .function("getMeshletTriangles", &TriGeometry::getMeshletTriangles)
+        .function("getMeshletBounds", &TriGeometry::getMeshletBounds)
+        .function("getBounds", &TriGeometry::getBounds)
+        .function("getBoundingSphere", &TriGeometry::getBoundingSphere);
 
     emscripten::class_<LineGeometry>("LineGeometry")
         .function("getPositions", &LineGeometry::getPositions)
-        .function("getSubMeshIndices", &LineGeometry::getSubMeshIndices);
+        .function("getSubMeshIndices", &LineGeometry::getSubMeshIndices)
+        .function("getBounds", &LineGeometry::getBounds)
+        .function("getBoundingSphere", &LineGeometry::getBoundingSphere);
 
     emscripten::class_<PointGeometry>("PointGeometry")
-        .function("getPositions", &PointGeometry::getPositions);
+        .function("getPositions", &PointGeometry::getPositions)
+        .function("getBounds", &PointGeometry::getBounds)
+        .function("getBoundingSphere", &PointGeometry::getBoundingSphere);
 
     emscripten::class_<Material>("Material")
         .function("getColor", &Material::getColor);
@@ -202,6 +920,8 @@ EMSCRIPTEN_BINDINGS(model_context_module) {
     emscripten::class_<Mesh>("Mesh")
         .function("getName", &Mesh::getName)
         .function("getTransform", &Mesh::getTransform)
+        .function("getWorldTransform", &Mesh::getWorldTransform)
+        .function("getWorldBounds", &Mesh::getWorldBounds)
         .function("getShapeType", &Mesh::getShapeType)
         .function("getTriGeometryIndex", &Mesh::getTriGeometryIndex)
         .function("getLineGeometryIndex", &Mesh::getLineGeometryIndex)
@@ -209,6 +929,15 @@ EMSCRIPTEN_BINDINGS(model_context_module) {
         .function("getMaterialIndex", &Mesh::getMaterialIndex)
         .function("getParentMeshIndex", &Mesh::getParentMeshIndex);
 
+    emscripten::class_<MaterialBatch>("MaterialBatch")
+        .function("getMaterialIndex", &MaterialBatch::getMaterialIndex)
+        .function("getMeshCount", &MaterialBatch::getMeshCount)
+        .function("getPositions", &MaterialBatch::getPositions)
+        .function("getNormals", &MaterialBatch::getNormals)
+        .function("getUVs", &MaterialBatch::getUVs)
+        .function("getIndices", &MaterialBatch::getIndices)
+        .function("getMeshRanges", &MaterialBatch::getMeshRanges);
+
     emscripten::class_<TriangulatedModel>("TriangulatedModel")
         .function("getTriCount", &TriangulatedModel::getTriCount)
         .function("getTri", &TriangulatedModel::getTri, emscripten::return_value_policy::reference())
@@ -219,7 +948,28 @@ EMSCRIPTEN_BINDINGS(model_context_module) {
         .function("getMaterialCount", &TriangulatedModel::getMaterialCount)
         .function("getMaterial", &TriangulatedModel::getMaterial, emscripten::return_value_policy::reference())
         .function("getMeshCount", &TriangulatedModel::getMeshCount)
-        .function("getMesh", &TriangulatedModel::getMesh, emscripten::return_value_policy::reference());
+        .function("getMesh", &TriangulatedModel::getMesh, emscripten::return_value_policy::reference())
+        .function("getMeshParentIndices", &TriangulatedModel::getMeshParentIndices)
+        .function("getMeshTriGeometryIndices", &TriangulatedModel::getMeshTriGeometryIndices)
+        .function("getMeshLineGeometryIndices", &TriangulatedModel::getMeshLineGeometryIndices)
+        .function("getMeshPointGeometryIndices", &TriangulatedModel::getMeshPointGeometryIndices)
+        .function("getMeshMaterialIndices", &TriangulatedModel::getMeshMaterialIndices)
+        .function("getMeshShapeTypes", &TriangulatedModel::getMeshShapeTypes)
+        .function("getMeshTransforms", &TriangulatedModel::getMeshTransforms)
+        .function("getMeshWorldTransforms", &TriangulatedModel::getMeshWorldTransforms)
+        .function("getMeshWorldBounds", &TriangulatedModel::getMeshWorldBounds)
+        .function("getBounds", &TriangulatedModel::getBounds)
+        .function("getLodCount", &TriangulatedModel::getLodCount)
+        .function("getTriLod", &TriangulatedModel::getTriLod, emscripten::return_value_policy::reference())
+        .function("getTriInstanceCount", &TriangulatedModel::getTriInstanceCount)
+        .function("getTriInstanceMeshIndices", &TriangulatedModel::getTriInstanceMeshIndices)
+        .function("getTriInstanceTransforms", &TriangulatedModel::getTriInstanceTransforms)
+        .function("getMaterialBatchCount", &TriangulatedModel::getMaterialBatchCount)
+        .function("getMaterialBatch", &TriangulatedModel::getMaterialBatch, emscripten::return_value_policy::reference())
+        .function("toGLB", &TriangulatedModel::toGLB)
+        .function("toTriangulatedCache", &TriangulatedModel::toTriangulatedCache)
+        .class_function("fromTriangulatedCache", &TriangulatedModel::fromTriangulatedCache, emscripten::return_value_policy::take_ownership())
+        .class_function("fromTriangulatedCacheBuffer", &TriangulatedModel::fromTriangulatedCacheBuffer, emscripten::return_value_policy::take_ownership());
 
     emscripten::register_optional<TriangulatedModel>();
 
@@ -227,12 +977,39 @@ EMSCRIPTEN_BINDINGS(model_context_module) {
     CREATE_EMSCRIPTEN_ASYNC_TASK_BINDINGS(TriangulationAsyncTask)       
 #endif
 
+    emscripten::class_<TriangulationOptions>("TriangulationOptions")
+        .constructor<>()
+        .property("linearDeflection", &TriangulationOptions::linearDeflection)
+        .property("angularDeflection", &TriangulationOptions::angularDeflection)
+        .property("relative", &TriangulationOptions::relative)
+        .property("minSize", &TriangulationOptions::minSize)
+        .property("parallel", &TriangulationOptions::parallel)
+        .property("lodCount", &TriangulationOptions::lodCount)
+        .property("lodDeflectionScale", &TriangulationOptions::lodDeflectionScale)
+        .property("vertexLayout", &TriangulationOptions::vertexLayout)
+        .property("compactIndices", &TriangulationOptions::compactIndices)
+        .property("optimizeVertexCache", &TriangulationOptions::optimizeVertexCache)
+        .property("buildMeshlets", &TriangulationOptions::buildMeshlets)
+        .property("weldVertices", &TriangulationOptions::weldVertices)
+        .property("weldAngle", &TriangulationOptions::weldAngle)
+        .property("mergeByMaterial", &TriangulationOptions::mergeByMaterial)
+        .function("isValid", &TriangulationOptions::isValid);
+
     emscripten::class_<ModelContext>("ModelContext")
         .function("computeTriangulation", &ModelContext::computeTriangulation)
+        .function("computeTriangulation", &ModelContext::computeTriangulationWithOptions)
 #ifdef __EMSCRIPTEN_PTHREADS__
         .function("computeTriangulationAsync", &ModelContext::computeTriangulationAsync)
+        .function("computeTriangulationAsync", &ModelContext::computeTriangulationAsyncWithPriority)
+        .function("computeTriangulationAsync", &ModelContext::computeTriangulationAsyncWithOptions)
+        .function("computeTriangulationProgressiveAsync", &ModelContext::computeTriangulationProgressiveAsync)
+        .function("applyRefinements", &ModelContext::applyRefinements)
 #endif
-        .function("getTriangulatedModel", &ModelContext::getTriangulatedModel, emscripten::return_value_policy::reference());
+        .function("getTriangulatedModel", &ModelContext::getTriangulatedModel, emscripten::return_value_policy::reference())
+        .function("getContentHash", &ModelContext::getContentHash)
+        .function("setTriangulationCache", &ModelContext::setTriangulationCache, emscripten::allow_raw_pointers())
+        .function("raycast", &ModelContext::raycast)
+        .function("raycastMany", &ModelContext::raycastMany);
 
     emscripten::register_optional<ModelContext>();
 }
@@ -9,8 +9,12 @@
 
 #include <emscripten/val.h>
 
+#include <algorithm>
 #include <array>
+#include <cmath>
 #include <cstdint>
+#include <limits>
+#include <memory>
 #include <optional>
 #include <string>
 #include <vector>
@@ -23,17 +27,68 @@
 #include <gp_Trsf.hxx>
 
 #include "common.hpp"
+#include "task_progress.hpp"
 #ifdef __EMSCRIPTEN_PTHREADS__
 #include "async_task.hpp"
+#include "task_scheduler.hpp"
 #endif
 
+// axis-aligned bounds as min xyz, max xyz. empty bounds have min > max.
+using Bounds = std::array<float, 6>;
+inline constexpr Bounds EMPTY_BOUNDS = {
+    std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity(),
+    -std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity()
+};
+// bounding sphere as center xyz, radius. empty spheres have a negative radius.
+using BoundingSphere = std::array<float, 4>;
+inline constexpr BoundingSphere EMPTY_BOUNDING_SPHERE = { 0.0f, 0.0f, 0.0f, -1.0f };
+
+enum class VertexLayout {
+    Separate, // positions, normals and uvs in their own arrays
+    Interleaved, // position, normal and uv of each vertex next to each other in vertices
+    Quantized // interleaved 16-bit position, oct-encoded normal and uv in quantizedVertices
+};
+
+enum class IndexFormat {
+    Uint32, // indices
+    Uint16 // indices16
+};
+
 class TriGeometry {
 public:
+    // interleaved vertex layout, in floats
+    static constexpr size_t INTERLEAVED_STRIDE = 8;
+    static constexpr size_t INTERLEAVED_POSITION_OFFSET = 0;
+    static constexpr size_t INTERLEAVED_NORMAL_OFFSET = 3;
+    static constexpr size_t INTERLEAVED_UV_OFFSET = 6;
+    // quantized vertex layout, in uint16 values: unorm16 xyz against the bounding box and a padding value,
+    // oct-encoded snorm16 normal, unorm16 uv
+    static constexpr size_t QUANTIZED_STRIDE = 8;
+    static constexpr size_t QUANTIZED_POSITION_OFFSET = 0;
+    static constexpr size_t QUANTIZED_NORMAL_OFFSET = 4;
+    static constexpr size_t QUANTIZED_UV_OFFSET = 6;
+
+public:
+    VertexLayout layout = VertexLayout::Separate;
     std::vector<float> positions;
     std::vector<float> normals;
     std::vector<float> uvs;
+    std::vector<float> vertices; // interleaved layout only
+    std::vector<uint16_t> quantizedVertices; // quantized layout only
+    // maps normalized quantized positions to the geometry space, column-major
+    std::array<float, 16> dequantizationMatrix = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+    IndexFormat indexFormat = IndexFormat::Uint32;
     std::vector<uint32_t> indices; // triangle indices
+    std::vector<uint16_t> indices16; // triangle indices, Uint16 index format only
     std::vector<uint32_t> subMeshIndices; // verticesCount
+    std::vector<uint32_t> subMeshIndexCounts; // indexCount per face
+    // meshlets, see MeshOptimizer::buildMeshlets
+    std::vector<uint32_t> meshlets; // vertex offset, triangle offset, vertex count, triangle count
+    std::vector<uint32_t> meshletVertices;
+    std::vector<uint8_t> meshletTriangles;
+    std::vector<float> meshletBounds; // sphere center xyz, radius, cone axis xyz, cone cutoff
+    Bounds bounds = EMPTY_BOUNDS;
+    BoundingSphere boundingSphere = EMPTY_BOUNDING_SPHERE;
 
 public:
     TriGeometry() = default;
@@ -57,17 +112,51 @@ public:
         subMeshIndices.shrink_to_fit();
     }
 
+    size_t getVertexCount() const;
+    size_t getIndexCount() const;
+    uint32_t indexAt(size_t i) const {
+        return indexFormat == IndexFormat::Uint16 ? indices16[i] : indices[i];
+    }
+    // vertex attributes in the geometry space, whatever the layout
+    std::array<float, 3> getVertexPosition(size_t vertex) const;
+    std::array<float, 3> getVertexNormal(size_t vertex) const;
+    std::array<float, 2> getVertexUV(size_t vertex) const;
+    // moves vertex i to remap[i] in every vertex attribute of the layout, indices are left as is.
+    // vertices mapped to the same slot are merged, keeping the first one.
+    void remapVertices(const std::vector<uint32_t>& remap, size_t newVertexCount);
+
+    VertexLayout getLayout() const;
     Float32Array getPositions() const;
     Float32Array getNormals() const;
     Float32Array getUVs() const;
+    Float32Array getVertices() const;
+    Uint16Array getQuantizedVertices() const;
+    Float32Array getDequantizationMatrix() const;
+    // interleaved and quantized layouts, in bytes
+    size_t getVertexStride() const;
+    size_t getPositionOffset() const;
+    size_t getNormalOffset() const;
+    size_t getUVOffset() const;
+    IndexFormat getIndexFormat() const;
     Uint32Array getIndices() const;
+    Uint16Array getIndices16() const;
     Uint32Array getSubMeshIndices() const;
+    Uint32Array getSubMeshIndexCounts() const;
+    size_t getMeshletCount() const;
+    Uint32Array getMeshlets() const;
+    Uint32Array getMeshletVertices() const;
+    Uint8Array getMeshletTriangles() const;
+    Float32Array getMeshletBounds() const;
+    Float32Array getBounds() const;
+    Float32Array getBoundingSphere() const;
 };
 
 class LineGeometry {
 public:
     std::vector<float> positions;
     std::vector<uint32_t> subMeshIndices; // verticesCount
+    Bounds bounds = EMPTY_BOUNDS;
+    BoundingSphere boundingSphere = EMPTY_BOUNDING_SPHERE;
 
 public:
     LineGeometry() = default;
@@ -84,6 +173,8 @@ public:
 
     Float32Array getPositions() const;
     Uint32Array getSubMeshIndices() const;
+    Float32Array getBounds() const;
+    Float32Array getBoundingSphere() const;
 };
 
 class Material {
@@ -97,11 +188,14 @@ public:
     {
     }
     Float32Array getColor() const;
+    const std::array<float, 3>& getColorData() const { return color; }
 };
 
 class PointGeometry {
 public:
     std::vector<float> positions;
+    Bounds bounds = EMPTY_BOUNDS;
+    BoundingSphere boundingSphere = EMPTY_BOUNDING_SPHERE;
 
 public:
     PointGeometry() = default;
@@ -112,6 +206,8 @@ public:
     }
 
     Float32Array getPositions() const;
+    Float32Array getBounds() const;
+    Float32Array getBoundingSphere() const;
 };
 
 enum class MeshShapeType {
@@ -127,6 +223,8 @@ class Mesh {
 private:
     std::string name;
     std::array<float, 16> transform;
+    std::array<float, 16> worldTransform;
+    Bounds worldBounds; // of the mesh geometries and its children, in world space
     MeshShapeType shapeType;
     int triGeometryIndex;
     int lineGeometryIndex;
@@ -138,6 +236,8 @@ public:
     Mesh(
         std::string name,
         const std::array<float, 16>& transform,
+        const std::array<float, 16>& worldTransform,
+        const Bounds& worldBounds,
         MeshShapeType shapeType,
         int triGeometryIndex,
         int lineGeometryIndex,
@@ -147,6 +247,8 @@ public:
     )
         : name(std::move(name))
         , transform(transform)
+        , worldTransform(worldTransform)
+        , worldBounds(worldBounds)
         , shapeType(shapeType)
         , triGeometryIndex(triGeometryIndex)
         , lineGeometryIndex(lineGeometryIndex)
@@ -157,12 +259,42 @@ public:
     }
     const std::string& getName() const;
     Float32Array getTransform() const;
+    Float32Array getWorldTransform() const;
+    Float32Array getWorldBounds() const;
     MeshShapeType getShapeType() const;
     int getTriGeometryIndex() const;
     int getLineGeometryIndex() const;
     int getPointGeometryIndex() const;
     int getMaterialIndex() const;
     int getParentMeshIndex() const;
+
+    const std::array<float, 16>& getTransformData() const { return transform; }
+    const std::array<float, 16>& getWorldTransformData() const { return worldTransform; }
+    const Bounds& getWorldBoundsData() const { return worldBounds; }
+    void setWorldBounds(const Bounds& bounds) { worldBounds = bounds; }
+    void expandWorldBounds(const Bounds& other);
+};
+
+// world-space tri geometries of all meshes sharing a material, merged to be drawn in one call.
+// always in the separate layout with 32-bit indices.
+class MaterialBatch {
+public:
+    static constexpr size_t MESH_RANGE_STRIDE = 5; // mesh index, first index, index count, first vertex, vertex count
+
+    int materialIndex = -1; // -1 for meshes without material
+    std::vector<float> positions;
+    std::vector<float> normals;
+    std::vector<float> uvs;
+    std::vector<uint32_t> indices;
+    std::vector<uint32_t> meshRanges; // MESH_RANGE_STRIDE values per merged mesh, in mesh order
+
+    int getMaterialIndex() const;
+    size_t getMeshCount() const;
+    Float32Array getPositions() const;
+    Float32Array getNormals() const;
+    Float32Array getUVs() const;
+    Uint32Array getIndices() const;
+    Uint32Array getMeshRanges() const;
 };
 
 class TriangulatedModel {
@@ -172,6 +304,28 @@ private:
     std::vector<PointGeometry> points;
     std::vector<Material> materials;
     std::vector<Mesh> meshes;
+    std::vector<TriGeometry> lodTris; // coarse levels, (lodCount - 1) per tri geometry
+    size_t lodCount;
+    std::vector<MaterialBatch> materialBatches;
+    Bounds bounds = EMPTY_BOUNDS;
+    // meshes grouped by tri geometry, for instanced drawing
+    std::vector<uint32_t> triInstanceOffsets; // first instance of each tri geometry, triCount + 1 entries
+    std::vector<uint32_t> triInstanceMeshIndices;
+    std::vector<float> triInstanceTransforms; // world transforms, 16 floats per instance
+    // mesh fields by column, so that JS reads the whole scene without a call per mesh
+    std::vector<int32_t> meshParentIndices;
+    std::vector<int32_t> meshTriGeometryIndices;
+    std::vector<int32_t> meshLineGeometryIndices;
+    std::vector<int32_t> meshPointGeometryIndices;
+    std::vector<int32_t> meshMaterialIndices;
+    std::vector<uint8_t> meshShapeTypes;
+    std::vector<float> meshTransforms; // 16 floats per mesh
+    std::vector<float> meshWorldTransforms; // 16 floats per mesh
+    std::vector<float> meshWorldBounds; // 6 floats per mesh
+
+    void buildTriInstances();
+    void buildMeshTable();
+    void updateModelBounds(); // from the root mesh bounds
     
 public:
     TriangulatedModel(
@@ -179,14 +333,23 @@ public:
         std::vector<LineGeometry> lines,
         std::vector<PointGeometry> points,
         std::vector<Material> materials,
-        std::vector<Mesh> meshes
+        std::vector<Mesh> meshes,
+        std::vector<TriGeometry> lodTris = {},
+        size_t lodCount = 1,
+        std::vector<MaterialBatch> materialBatches = {}
     )
         : tris(std::move(tris))
         , lines(std::move(lines))
         , points(std::move(points))
         , materials(std::move(materials))
         , meshes(std::move(meshes))
+        , lodTris(std::move(lodTris))
+        , lodCount(lodCount)
+        , materialBatches(std::move(materialBatches))
     {
+        updateModelBounds();
+        buildTriInstances();
+        buildMeshTable();
         tris.shrink_to_fit();
         lines.shrink_to_fit();
         points.shrink_to_fit();
@@ -204,8 +367,138 @@ public:
     Material& getMaterial(size_t index);
     size_t getMeshCount() const;
     Mesh& getMesh(size_t index);
+    // the fields of all meshes as typed arrays indexed by mesh, matrices are column-major
+    Int32Array getMeshParentIndices() const;
+    Int32Array getMeshTriGeometryIndices() const;
+    Int32Array getMeshLineGeometryIndices() const;
+    Int32Array getMeshPointGeometryIndices() const;
+    Int32Array getMeshMaterialIndices() const;
+    Uint8Array getMeshShapeTypes() const; // MeshShapeType as its declaration order, Shell = 0
+    Float32Array getMeshTransforms() const;
+    Float32Array getMeshWorldTransforms() const;
+    Float32Array getMeshWorldBounds() const;
+    // world bounds of the whole model
+    Float32Array getBounds() const;
+    size_t getLodCount() const;
+    // level 0 is the geometry returned by getTri, higher levels are coarser
+    TriGeometry& getTriLod(size_t index, size_t level);
+    // occurrences of a tri geometry, in mesh order; one instanced draw per tri geometry covers the whole model
+    size_t getTriInstanceCount(size_t index) const;
+    Uint32Array getTriInstanceMeshIndices(size_t index) const;
+    Float32Array getTriInstanceTransforms(size_t index) const; // column-major world matrices, 16 floats per instance
+
+    // empty unless TriangulationOptions::mergeByMaterial is set.
+    // built with the model geometries, setTri does not update them.
+    size_t getMaterialBatchCount() const;
+    MaterialBatch& getMaterialBatch(size_t index);
+
+    // binary glTF of the model, see ModelGlbExport
+    ByteBuffer toGLB();
+    // snapshot to store and reopen the model without meshing it again, see ModelSerialization
+    ByteBuffer toTriangulatedCache();
+    static std::optional<TriangulatedModel> fromTriangulatedCache(const Uint8Array& buffer);
+    // reads the buffer in place, without copying it out of the wasm heap
+    static std::optional<TriangulatedModel> fromTriangulatedCacheBuffer(const ByteBuffer& buffer);
+
+    // replaces the geometry in place, so that references to it stay valid.
+    // the bounds are updated by updateBounds, once for all replaced geometries.
+    void setTri(size_t index, TriGeometry&& geometry);
+    // recomputes the world bounds of the meshes and of the model from the current geometries
+    void updateBounds();
+};
+
+// tessellation quality, see IMeshTools_Parameters
+class TriangulationOptions {
+public:
+    // relative: coefficient of the shape bounding box size, absolute: chordal deviation in model units
+    double linearDeflection = 0.001;
+    double angularDeflection = 0.2; // radians
+    bool relative = true;
+    double minSize = 0.0; // minimal element size, 0 leaves it to BRepMesh
+    bool parallel = true; // mesh faces and unique shapes concurrently (multithreaded builds only)
+    int lodCount = 1; // levels of detail per tri geometry
+    double lodDeflectionScale = 4.0; // deflection multiplier from one level to the next coarser one
+    VertexLayout vertexLayout = VertexLayout::Separate;
+    bool compactIndices = false; // use 16-bit indices for geometries with up to 65535 vertices
+    bool optimizeVertexCache = false; // reorder triangles and vertices of each face for GPU vertex cache and fetch
+    bool buildMeshlets = false; // split tri geometries into meshlets with culling bounds
+    // merge coincident vertices across faces whose normals differ by at most weldAngle (radians)
+    bool weldVertices = false;
+    double weldAngle = 0.5;
+    // also merge the meshes into world-space material batches. the batches copy every instance of the
+    // tri geometries, so they add to the model memory rather than replace it.
+    bool mergeByMaterial = false;
+
+public:
+    bool operator==(const TriangulationOptions& other) const {
+        return linearDeflection == other.linearDeflection
+            && angularDeflection == other.angularDeflection
+            && relative == other.relative
+            && minSize == other.minSize
+            && parallel == other.parallel
+            && lodCount == other.lodCount
+            && lodDeflectionScale == other.lodDeflectionScale
+            && vertexLayout == other.vertexLayout
+            && compactIndices == other.compactIndices
+            && optimizeVertexCache == other.optimizeVertexCache
+            && buildMeshlets == other.buildMeshlets
+            && weldVertices == other.weldVertices
+            && weldAngle == other.weldAngle
+            && mergeByMaterial == other.mergeByMaterial;
+    }
+    bool operator!=(const TriangulationOptions& other) const {
+        return !(*this == other);
+    }
+
+    // deflections and the level scale must be positive, minSize and weldAngle non-negative. NaN is invalid.
+    bool isValid() const {
+        return std::isfinite(linearDeflection) && linearDeflection > 0.0
+            && std::isfinite(angularDeflection) && angularDeflection > 0.0
+            && std::isfinite(minSize) && minSize >= 0.0
+            && std::isfinite(lodDeflectionScale) && lodDeflectionScale > 0.0
+            && std::isfinite(weldAngle) && weldAngle >= 0.0;
+    }
+};
+
+// nearest intersection of a ray with the tri geometries of a model, in world space
+struct RaycastHit {
+    int meshIndex;
+    int faceIndex; // sub mesh of the tri geometry
+    int triangleIndex; // within the tri geometry
+    float distance;
+    std::array<float, 3> point;
+};
+
+// hits of a batch of rays, one entry per ray in ray order.
+// a missed ray has -1 indices, an infinite distance and a zero point.
+class RaycastBatch {
+public:
+    std::vector<int32_t> meshIndices;
+    std::vector<int32_t> faceIndices;
+    std::vector<int32_t> triangleIndices;
+    std::vector<float> distances;
+    std::vector<float> points; // xyz per ray
+
+    explicit RaycastBatch(size_t rayCount = 0)
+        : meshIndices(rayCount, -1)
+        , faceIndices(rayCount, -1)
+        , triangleIndices(rayCount, -1)
+        , distances(rayCount, std::numeric_limits<float>::infinity())
+        , points(rayCount * 3, 0.0f)
+    {
+    }
+
+    size_t getRayCount() const;
+    Int32Array getMeshIndices() const;
+    Int32Array getFaceIndices() const;
+    Int32Array getTriangleIndices() const;
+    Float32Array getDistances() const;
+    Float32Array getPoints() const;
 };
 
+class ModelRaycaster;
+class TriangulationCache;
+
 #ifdef __EMSCRIPTEN_PTHREADS__
 using TriangulationAsyncTask = AsyncTask<bool>;
 #endif
@@ -217,8 +510,21 @@ private:
     Handle(XCAFDoc_ColorTool) colorTool;
 
     std::optional<TriangulatedModel> triangulatedModel;
+    TriangulationOptions triangulationOptions; // options of triangulatedModel
+    std::shared_ptr<ModelRaycaster> raycaster; // built on the first raycast, reset whenever triangulatedModel changes
+    std::optional<uint64_t> contentHash; // of the imported file
+    TriangulationCache* triangulationCache = nullptr; // owned by JS
 #ifdef __EMSCRIPTEN_PTHREADS__
-    mutable std::mutex triangulationMutex;
+    mutable std::mutex triangulationMutex; // held while triangulatedModel is computed and replaced
+
+    // refined geometries of a progressive triangulation, waiting for applyRefinements
+    std::mutex refinementMutex;
+    std::vector<std::pair<size_t, TriGeometry>> pendingRefinements;
+    uint64_t modelGeneration = 0; // bumped whenever triangulatedModel is replaced, so that stale refinements are dropped
+    Handle(TaskProgress) refinementProgress; // of the refinement of the current model, if any
+    std::vector<uint32_t> refinedTriIndices; // returned by the last applyRefinements
+    // held by a running refinement, as only one triangulation at a time may mesh the document shapes
+    std::mutex refiningMutex;
 #endif
 
 public:
@@ -232,23 +538,30 @@ public:
     ModelContext(const ModelContext& other) :
         doc(other.doc),
         shapeTool(other.shapeTool),
-        colorTool(other.colorTool)
+        colorTool(other.colorTool),
+        contentHash(other.contentHash),
+        triangulationCache(other.triangulationCache)
     {
 #ifdef __EMSCRIPTEN_PTHREADS__
         std::lock_guard<std::mutex> lock(other.triangulationMutex);
 #endif
         triangulatedModel = other.triangulatedModel;
+        triangulationOptions = other.triangulationOptions;
     }
 
     ModelContext(ModelContext&& other) noexcept :
         doc(std::move(other.doc)),
         shapeTool(std::move(other.shapeTool)),
-        colorTool(std::move(other.colorTool))
+        colorTool(std::move(other.colorTool)),
+        contentHash(other.contentHash),
+        triangulationCache(other.triangulationCache)
     {
 #ifdef __EMSCRIPTEN_PTHREADS__
         std::lock_guard<std::mutex> lock(other.triangulationMutex);
 #endif
         triangulatedModel = std::move(other.triangulatedModel);
+        triangulationOptions = other.triangulationOptions;
+        other.raycaster.reset();
     }
 
     ModelContext& operator=(const ModelContext& other) {
@@ -256,11 +569,15 @@ public:
             doc = other.doc;
             shapeTool = other.shapeTool;
             colorTool = other.colorTool;
+            contentHash = other.contentHash;
+            triangulationCache = other.triangulationCache;
 #ifdef __EMSCRIPTEN_PTHREADS__
             std::lock_guard<std::mutex> lockOther(other.triangulationMutex);
             std::lock_guard<std::mutex> lockThis(triangulationMutex);
 #endif
             triangulatedModel = other.triangulatedModel;
+            triangulationOptions = other.triangulationOptions;
+            raycaster.reset();
         }
         return *this;
     }
@@ -270,18 +587,73 @@ public:
             doc = std::move(other.doc);
             shapeTool = std::move(other.shapeTool);
             colorTool = std::move(other.colorTool);
+            contentHash = other.contentHash;
+            triangulationCache = other.triangulationCache;
 #ifdef __EMSCRIPTEN_PTHREADS__
             std::lock_guard<std::mutex> lockOther(other.triangulationMutex);
             std::lock_guard<std::mutex> lockThis(triangulationMutex);
 #endif
             triangulatedModel = std::move(other.triangulatedModel);
+            triangulationOptions = other.triangulationOptions;
+            raycaster.reset();
+            other.raycaster.reset();
         }
         return *this;
     }
 
+private:
+    // returns whether a model is available afterwards, read while the model is still locked
+    bool computeTriangulationInternal(const TriangulationOptions& options, const Handle(TaskProgress)& progress);
+#ifdef __EMSCRIPTEN_PTHREADS__
+    // cancels the refinement of the current model and waits for it to stop meshing, with triangulationMutex held.
+    // returns the generation of the model about to be computed.
+    uint64_t beginModelReplacement(const Handle(TaskProgress)& nextRefinementProgress);
+#endif
+
+public:
+    // the cached model is recomputed when the options differ from the ones it was built with
     void computeTriangulation();
+    void computeTriangulationWithOptions(const TriangulationOptions& options);
 #ifdef __EMSCRIPTEN_PTHREADS__
-    void computeTriangulationAsync(TriangulationAsyncTask& task);
+    // the returned promise resolves once the task is completed
+    emscripten::val computeTriangulationAsync(TriangulationAsyncTask& task);
+    emscripten::val computeTriangulationAsyncWithPriority(TriangulationAsyncTask& task, TaskPriority priority);
+    emscripten::val computeTriangulationAsyncWithOptions(TriangulationAsyncTask& task, TaskPriority priority, const TriangulationOptions& options);
+
+    // computes a coarse model first, then remeshes its tri geometries with the given options in the background.
+    // returns { coarse, refined } promises resolved with coarseTask and refineTask.
+    // levels of detail are not produced in this mode, and line and point geometries keep the coarse
+    // deflection, so edges may be off the refined faces by up to the coarse deflection.
+    // another triangulation of this context cancels the refinement, the refined promise then resolves to false.
+    // mergeByMaterial is not supported, both promises resolve to false with it.
+    emscripten::val computeTriangulationProgressiveAsync(
+        TriangulationAsyncTask& coarseTask,
+        TriangulationAsyncTask& refineTask,
+        TaskPriority priority,
+        const TriangulationOptions& options
+    );
+    // moves the refined geometries finished so far into the model, returns their tri geometry indices.
+    // must be called from the main runtime thread; the returned array is valid until the next call.
+    Uint32Array applyRefinements();
 #endif
     std::optional<TriangulatedModel>& getTriangulatedModel();
+
+    void setContentHash(uint64_t hash);
+    // XXH64 of the imported file as 16 hex digits, to key whole-model caches such as
+    // TriangulatedModel::toTriangulatedCache. empty if the model was not imported from bytes.
+    std::string getContentHash() const;
+
+    // meshed solids and shells are looked up in and stored into the cache, so that the ones unchanged
+    // since an earlier import are not meshed again. null to disable; the cache must outlive the
+    // triangulations started while it is set.
+    void setTriangulationCache(TriangulationCache* cache);
+
+    // nearest hit of the ray with the triangulated model, the direction does not need to be normalized.
+    // the acceleration structure is built on the first call after each triangulation.
+    std::optional<RaycastHit> raycast(float originX, float originY, float originZ, float directionX, float directionY, float directionZ);
+    // raycast for each xyz triple of origins and directions, in one call
+    RaycastBatch raycastMany(const Float32Array& origins, const Float32Array& directions);
+
+private:
+    ModelRaycaster* getRaycaster();
 };
@@ -0,0 +1,413 @@
+// Copyright (c) 2025 SolverX Corporation
+// This file is part of MIE OpenCascade WebAssembly Bindings.
+//
+// This library is free software; you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License version 2.1 as published
+// by the Free Software Foundation.
+
+#include "model_glb_export.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace {
+
+constexpr uint32_t GLB_MAGIC = 0x46546C67; // "glTF"
+constexpr uint32_t GLB_VERSION = 2;
+constexpr uint32_t GLB_CHUNK_JSON = 0x4E4F534A;
+constexpr uint32_t GLB_CHUNK_BIN = 0x004E4942;
+
+constexpr int COMPONENT_UNSIGNED_SHORT = 5123;
+constexpr int COMPONENT_UNSIGNED_INT = 5125;
+constexpr int COMPONENT_FLOAT = 5126;
+
+constexpr int TARGET_ARRAY_BUFFER = 34962;
+constexpr int TARGET_ELEMENT_ARRAY_BUFFER = 34963;
+
+constexpr int MODE_POINTS = 0;
+constexpr int MODE_LINES = 1;
+constexpr int MODE_TRIANGLES = 4;
+
+constexpr int NONE = -1;
+
+std::string formatFloat(float value) {
+    char text[32];
+    std::snprintf(text, sizeof(text), "%.9g", static_cast<double>(value));
+    return text;
+}
+
+std::string formatFloats(const float* values, size_t count) {
+    std::string text = "[";
+    for (size_t i = 0; i < count; ++i) {
+        if (i > 0) {
+            text += ",";
+        }
+        text += formatFloat(values[i]);
+    }
+    return text + "]";
+}
+
+std::string formatString(const std::string& value) {
+    std::string text = "\"";
+    for (const char c : value) {
+        switch (c) {
+        case '"': text += "\\\""; break;
+        case '\\': text += "\\\\"; break;
+        case '\n': text += "\\n"; break;
+        case '\r': text += "\\r"; break;
+        case '\t': text += "\\t"; break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                char escaped[8];
+                std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned int>(c));
+                text += escaped;
+            } else {
+                text += c;
+            }
+        }
+    }
+    return text + "\"";
+}
+
+std::string joinObjects(const std::vector<std::string>& objects) {
+    std::string text = "[";
+    for (size_t i = 0; i < objects.size(); ++i) {
+        if (i > 0) {
+            text += ",";
+        }
+        text += objects[i];
+    }
+    return text + "]";
+}
+
+void appendUint32(std::vector<uint8_t>& data, uint32_t value) {
+    const uint8_t bytes[4] = {
+        static_cast<uint8_t>(value),
+        static_cast<uint8_t>(value >> 8),
+        static_cast<uint8_t>(value >> 16),
+        static_cast<uint8_t>(value >> 24)
+    };
+    data.insert(data.end(), bytes, bytes + 4);
+}
+
+bool isIdentity(const std::array<float, 16>& matrix) {
+    for (size_t i = 0; i < 16; ++i) {
+        if (matrix[i] != (i % 5 == 0 ? 1.0f : 0.0f)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+struct PrimitiveAccessors {
+    int position = NONE;
+    int normal = NONE;
+    int uv = NONE;
+    int indices = NONE;
+};
+
+// collects buffer views and accessors over a single binary chunk
+class GlbBuilder {
+private:
+    std::vector<uint8_t> binary;
+    std::vector<std::string> bufferViews;
+    std::vector<std::string> accessors;
+
+public:
+    // 4-byte aligned, as required for every component type
+    int addBufferView(const void* data, size_t byteLength, int target, size_t byteStride = 0) {
+        binary.resize((binary.size() + 3) & ~size_t(3), 0);
+        const size_t byteOffset = binary.size();
+        binary.insert(binary.end(), static_cast<const uint8_t*>(data), static_cast<const uint8_t*>(data) + byteLength);
+
+        std::string view = "{\"buffer\":0,\"byteOffset\":" + std::to_string(byteOffset) + ",\"byteLength\":" + std::to_string(byteLength);
+        if (byteStride > 0) {
+            view += ",\"byteStride\":" + std::to_string(byteStride);
+        }
+        view += ",\"target\":" + std::to_string(target) + "}";
+        bufferViews.push_back(std::move(view));
+        return static_cast<int>(bufferViews.size() - 1);
+    }
+
+    int addAccessor(int bufferView, size_t byteOffset, int componentType, size_t count, const char* type, const Bounds* bounds = nullptr) {
+        std::string accessor = "{\"bufferView\":" + std::to_string(bufferView)
+            + ",\"byteOffset\":" + std::to_string(byteOffset)
+            + ",\"componentType\":" + std::to_string(componentType)
+            + ",\"count\":" + std::to_string(count)
+            + ",\"type\":\"" + type + "\"";
+        if (bounds != nullptr) {
+            // required for positions
+            accessor += ",\"min\":" + formatFloats(bounds->data(), 3) + ",\"max\":" + formatFloats(bounds->data() + 3, 3);
+        }
+        accessor += "}";
+        accessors.push_back(std::move(accessor));
+        return static_cast<int>(accessors.size() - 1);
+    }
+
+    int addFloatAccessor(const std::vector<float>& values, size_t componentCount, const char* type, const Bounds* bounds = nullptr) {
+        const int view = addBufferView(values.data(), values.size() * sizeof(float), TARGET_ARRAY_BUFFER);
+        return addAccessor(view, 0, COMPONENT_FLOAT, values.size() / componentCount, type, bounds);
+    }
+
+    int addIndexAccessor(const void* indices, size_t count, int componentType) {
+        const size_t componentSize = componentType == COMPONENT_UNSIGNED_SHORT ? 2 : 4;
+        const int view = addBufferView(indices, count * componentSize, TARGET_ELEMENT_ARRAY_BUFFER);
+        return addAccessor(view, 0, componentType, count, "SCALAR");
+    }
+
+    const std::vector<uint8_t>& getBinary() const { return binary; }
+    const std::vector<std::string>& getBufferViews() const { return bufferViews; }
+    const std::vector<std::string>& getAccessors() const { return accessors; }
+};
+
+// positions bounds, recomputed when the geometry has none
+Bounds getPositionBounds(const float* positions, size_t stride, size_t vertexCount, const Bounds& bounds) {
+    if (bounds[0] <= bounds[3]) {
+        return bounds;
+    }
+    Bounds result = EMPTY_BOUNDS;
+    for (size_t i = 0; i < vertexCount; ++i) {
+        for (size_t axis = 0; axis < 3; ++axis) {
+            result[axis] = std::min(result[axis], positions[i * stride + axis]);
+            result[axis + 3] = std::max(result[axis + 3], positions[i * stride + axis]);
+        }
+    }
+    return result;
+}
+
+PrimitiveAccessors writeTriGeometry(GlbBuilder& builder, const TriGeometry& geometry) {
+    PrimitiveAccessors result;
+    const size_t vertexCount = geometry.getVertexCount();
+    const size_t indexCount = geometry.getIndexCount();
+    if (vertexCount == 0 || indexCount == 0) {
+        return result;
+    }
+
+    if (geometry.layout == VertexLayout::Interleaved) {
+        // one strided view, as the data is laid out for the GPU already
+        const int view = builder.addBufferView(
+            geometry.vertices.data(), geometry.vertices.size() * sizeof(float), TARGET_ARRAY_BUFFER, TriGeometry::INTERLEAVED_STRIDE * sizeof(float));
+        const Bounds bounds = getPositionBounds(
+            geometry.vertices.data() + TriGeometry::INTERLEAVED_POSITION_OFFSET, TriGeometry::INTERLEAVED_STRIDE, vertexCount, geometry.bounds);
+        result.position = builder.addAccessor(view, TriGeometry::INTERLEAVED_POSITION_OFFSET * sizeof(float), COMPONENT_FLOAT, vertexCount, "VEC3", &bounds);
+        result.normal = builder.addAccessor(view, TriGeometry::INTERLEAVED_NORMAL_OFFSET * sizeof(float), COMPONENT_FLOAT, vertexCount, "VEC3");
+        result.uv = builder.addAccessor(view, TriGeometry::INTERLEAVED_UV_OFFSET * sizeof(float), COMPONENT_FLOAT, vertexCount, "VEC2");
+    } else if (geometry.layout == VertexLayout::Quantized) {
+        // octahedral normals have no glTF equivalent
+        std::vector<float> positions(vertexCount * 3);
+        std::vector<float> normals(vertexCount * 3);
+        std::vector<float> uvs(vertexCount * 2);
+        for (size_t i = 0; i < vertexCount; ++i) {
+            const std::array<float, 3> position = geometry.getVertexPosition(i);
+            const std::array<float, 3> normal = geometry.getVertexNormal(i);
+            const std::array<float, 2> uv = geometry.getVertexUV(i);
+            std::copy(position.begin(), position.end(), positions.begin() + i * 3);
+            std::copy(normal.begin(), normal.end(), normals.begin() + i * 3);
+            std::copy(uv.begin(), uv.end(), uvs.begin() + i * 2);
+        }
+        const Bounds bounds = getPositionBounds(positions.data(), 3, vertexCount, geometry.bounds);
+        result.position = builder.addFloatAccessor(positions, 3, "VEC3", &bounds);
+        result.normal = builder.addFloatAccessor(normals, 3, "VEC3");
+        result.uv = builder.addFloatAccessor(uvs, 2, "VEC2");
+    } else {
+        const Bounds bounds = getPositionBounds(geometry.positions.data(), 3, vertexCount, geometry.bounds);
+        result.position = builder.addFloatAccessor(geometry.positions, 3, "VEC3", &bounds);
+        result.normal = builder.addFloatAccessor(geometry.normals, 3, "VEC3");
+        result.uv = builder.addFloatAccessor(geometry.uvs, 2, "VEC2");
+    }
+
+    if (geometry.indexFormat == IndexFormat::Uint16) {
+        result.indices = builder.addIndexAccessor(geometry.indices16.data(), indexCount, COMPONENT_UNSIGNED_SHORT);
+    } else {
+        result.indices = builder.addIndexAccessor(geometry.indices.data(), indexCount, COMPONENT_UNSIGNED_INT);
+    }
+    return result;
+}
+
+// positions already hold the segments as vertex pairs, which glTF lines draw without indices
+PrimitiveAccessors writeLineGeometry(GlbBuilder& builder, const LineGeometry& geometry) {
+    PrimitiveAccessors result;
+    const size_t vertexCount = geometry.positions.size() / 3;
+    if (vertexCount < 2) {
+        return result;
+    }
+    const Bounds bounds = getPositionBounds(geometry.positions.data(), 3, vertexCount, geometry.bounds);
+    result.position = builder.addFloatAccessor(geometry.positions, 3, "VEC3", &bounds);
+    return result;
+}
+
+PrimitiveAccessors writePointGeometry(GlbBuilder& builder, const PointGeometry& geometry) {
+    PrimitiveAccessors result;
+    const size_t vertexCount = geometry.positions.size() / 3;
+    if (vertexCount == 0) {
+        return result;
+    }
+    const Bounds bounds = getPositionBounds(geometry.positions.data(), 3, vertexCount, geometry.bounds);
+    result.position = builder.addFloatAccessor(geometry.positions, 3, "VEC3", &bounds);
+    return result;
+}
+
+std::string formatPrimitive(const PrimitiveAccessors& accessors, int mode, int materialIndex) {
+    std::string primitive = "{\"attributes\":{\"POSITION\":" + std::to_string(accessors.position);
+    if (accessors.normal != NONE) {
+        primitive += ",\"NORMAL\":" + std::to_string(accessors.normal);
+    }
+    if (accessors.uv != NONE) {
+        primitive += ",\"TEXCOORD_0\":" + std::to_string(accessors.uv);
+    }
+    primitive += "}";
+    if (accessors.indices != NONE) {
+        primitive += ",\"indices\":" + std::to_string(accessors.indices);
+    }
+    if (materialIndex >= 0) {
+        primitive += ",\"material\":" + std::to_string(materialIndex);
+    }
+    primitive += ",\"mode\":" + std::to_string(mode) + "}";
+    return primitive;
+}
+
+} // namespace
+
+ByteBuffer ModelGlbExport::write(TriangulatedModel& model) {
+    GlbBuilder builder;
+
+    std::vector<PrimitiveAccessors> triAccessors(model.getTriCount());
+    for (size_t i = 0; i < triAccessors.size(); ++i) {
+        triAccessors[i] = writeTriGeometry(builder, model.getTri(i));
+    }
+    std::vector<PrimitiveAccessors> lineAccessors(model.getLineCount());
+    for (size_t i = 0; i < lineAccessors.size(); ++i) {
+        lineAccessors[i] = writeLineGeometry(builder, model.getLine(i));
+    }
+    std::vector<PrimitiveAccessors> pointAccessors(model.getPointCount());
+    for (size_t i = 0; i < pointAccessors.size(); ++i) {
+        pointAccessors[i] = writePointGeometry(builder, model.getPoint(i));
+    }
+
+    std::vector<std::string> materials;
+    for (size_t i = 0; i < model.getMaterialCount(); ++i) {
+        const std::array<float, 3>& color = model.getMaterial(i).getColorData();
+        const std::array<float, 4> baseColor = { color[0], color[1], color[2], 1.0f };
+        materials.push_back("{\"pbrMetallicRoughness\":{\"baseColorFactor\":" + formatFloats(baseColor.data(), 4)
+            + ",\"metallicFactor\":0,\"roughnessFactor\":1},\"doubleSided\":true}");
+    }
+
+    // one glTF mesh per distinct geometry and material combination
+    using MeshKey = std::tuple<int, int, int, int>;
+    std::map<MeshKey, int> meshMap;
+    std::vector<std::string> meshes;
+    std::vector<std::string> nodes;
+    std::vector<std::vector<size_t>> children(model.getMeshCount());
+    std::vector<size_t> rootNodes;
+    for (size_t meshIndex = 0; meshIndex < model.getMeshCount(); ++meshIndex) {
+        const Mesh& mesh = model.getMesh(meshIndex);
+        const int parentMeshIndex = mesh.getParentMeshIndex();
+        if (parentMeshIndex >= 0) {
+            children[static_cast<size_t>(parentMeshIndex)].push_back(meshIndex);
+        } else {
+            rootNodes.push_back(meshIndex);
+        }
+    }
+
+    for (size_t meshIndex = 0; meshIndex < model.getMeshCount(); ++meshIndex) {
+        const Mesh& mesh = model.getMesh(meshIndex);
+        std::vector<std::string> primitives;
+        if (mesh.getTriGeometryIndex() >= 0 && triAccessors[mesh.getTriGeometryIndex()].position != NONE) {
+            primitives.push_back(formatPrimitive(triAccessors[mesh.getTriGeometryIndex()], MODE_TRIANGLES, mesh.getMaterialIndex()));
+        }
+        if (mesh.getLineGeometryIndex() >= 0 && lineAccessors[mesh.getLineGeometryIndex()].position != NONE) {
+            primitives.push_back(formatPrimitive(lineAccessors[mesh.getLineGeometryIndex()], MODE_LINES, mesh.getMaterialIndex()));
+        }
+        if (mesh.getPointGeometryIndex() >= 0 && pointAccessors[mesh.getPointGeometryIndex()].position != NONE) {
+            primitives.push_back(formatPrimitive(pointAccessors[mesh.getPointGeometryIndex()], MODE_POINTS, mesh.getMaterialIndex()));
+        }
+
+        std::string node = "{\"name\":" + formatString(mesh.getName());
+        if (!isIdentity(mesh.getTransformData())) {
+            node += ",\"matrix\":" + formatFloats(mesh.getTransformData().data(), 16);
+        }
+        if (!primitives.empty()) {
+            const MeshKey key = { mesh.getTriGeometryIndex(), mesh.getLineGeometryIndex(), mesh.getPointGeometryIndex(), mesh.getMaterialIndex() };
+            const auto [meshIt, inserted] = meshMap.emplace(key, static_cast<int>(meshes.size()));
+            if (inserted) {
+                meshes.push_back("{\"primitives\":" + joinObjects(primitives) + "}");
+            }
+            node += ",\"mesh\":" + std::to_string(meshIt->second);
+        }
+        if (!children[meshIndex].empty()) {
+            node += ",\"children\":[";
+            for (size_t i = 0; i < children[meshIndex].size(); ++i) {
+                node += (i > 0 ? "," : "") + std::to_string(children[meshIndex][i]);
+            }
+            node += "]";
+        }
+        node += "}";
+        nodes.push_back(std::move(node));
+    }
+
+    // glTF arrays must not be empty, so an empty model has a scene without nodes
+    std::string scene = "{";
+    if (!rootNodes.empty()) {
+        scene += "\"nodes\":[";
+        for (size_t i = 0; i < rootNodes.size(); ++i) {
+            scene += (i > 0 ? "," : "") + std::to_string(rootNodes[i]);
+        }
+        scene += "]";
+    }
+    scene += "}";
+
+    const std::vector<uint8_t>& binary = builder.getBinary();
+    std::string json = "{\"asset\":{\"version\":\"2.0\",\"generator\":\"mie-occ-wasm\"}"
+        ",\"scene\":0,\"scenes\":[" + scene + "]";
+    if (!nodes.empty()) {
+        json += ",\"nodes\":" + joinObjects(nodes);
+    }
+    if (!meshes.empty()) {
+        json += ",\"meshes\":" + joinObjects(meshes);
+    }
+    if (!materials.empty()) {
+        json += ",\"materials\":" + joinObjects(materials);
+    }
+    if (!binary.empty()) {
+        json += ",\"accessors\":" + joinObjects(builder.getAccessors())
+            + ",\"bufferViews\":" + joinObjects(builder.getBufferViews())
+            + ",\"buffers\":[{\"byteLength\":" + std::to_string(binary.size()) + "}]";
+    }
+    json += "}";
+
+    // chunks are padded to 4 bytes, JSON with spaces and binary with zeros
+    const size_t jsonChunkLength = (json.size() + 3) & ~size_t(3);
+    const size_t binaryChunkLength = (binary.size() + 3) & ~size_t(3);
+    const size_t totalLength = 12 + 8 + jsonChunkLength + (binary.empty() ? 0 : 8 + binaryChunkLength);
+
+    std::vector<uint8_t> header;
+    appendUint32(header, GLB_MAGIC);
+    appendUint32(header, GLB_VERSION);
+    appendUint32(header, static_cast<uint32_t>(totalLength));
+    appendUint32(header, static_cast<uint32_t>(jsonChunkLength));
+    appendUint32(header, GLB_CHUNK_JSON);
+
+    ByteBuffer glb(totalLength);
+    uint8_t* out = glb.getData();
+    std::memcpy(out, header.data(), header.size());
+    out += header.size();
+    std::memcpy(out, json.data(), json.size());
+    std::memset(out + json.size(), ' ', jsonChunkLength - json.size());
+    out += jsonChunkLength;
+    if (!binary.empty()) {
+        std::vector<uint8_t> binaryHeader;
+        appendUint32(binaryHeader, static_cast<uint32_t>(binaryChunkLength));
+        appendUint32(binaryHeader, GLB_CHUNK_BIN);
+        std::memcpy(out, binaryHeader.data(), binaryHeader.size());
+        out += binaryHeader.size();
+        std::memcpy(out, binary.data(), binary.size());
+        std::memset(out + binary.size(), 0, binaryChunkLength - binary.size());
+    }
+    return glb;
+}
@@ -0,0 +1,19 @@
+// Copyright (c) 2025 SolverX Corporation
+// This file is part of MIE OpenCascade WebAssembly Bindings.
+//
+// This library is free software; you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License version 2.1 as published
+// by the Free Software Foundation.
+
+#pragma once
+
+#include "common.hpp"
+#include "model_context.hpp"
+
+class ModelGlbExport {
+public:
+    // binary glTF 2.0 of the model, one node per mesh following parentMeshIndex.
+    // meshes with the same geometries and material share a glTF mesh, so repeated parts are instanced.
+    // quantized geometries are written back as floats, line geometries as line lists.
+    static ByteBuffer write(TriangulatedModel& model);
+};
@@ -0,0 +1,427 @@
+// Copyright (c) 2025 SolverX Corporation
+// This file is part of MIE OpenCascade WebAssembly Bindings.
+//
+// This library is free software; you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License version 2.1 as published
+// by the Free Software Foundation.
+
+#include "model_raycaster.hpp"
+
+#include <emscripten/bind.h>
+
+#include <cmath>
+
+#ifdef __EMSCRIPTEN_PTHREADS__
+#include "task_scheduler.hpp"
+#endif
+
+namespace {
+
+// inverse of the affine part of a column-major 4x4 matrix, as a column-major 3x4 matrix
+std::array<float, 12> invertAffine(const std::array<float, 16>& m) {
+    const float a = m[0], b = m[4], c = m[8];
+    const float d = m[1], e = m[5], f = m[9];
+    const float g = m[2], h = m[6], i = m[10];
+    const float determinant = a * (e * i - f * h) - b * (d * i - f * g) + c * (d * h - e * g);
+    const float inverseDeterminant = determinant != 0.0f ? 1.0f / determinant : 0.0f;
+
+    std::array<float, 12> result;
+    // rows of the inverse 3x3, stored by column
+    result[0] = (e * i - f * h) * inverseDeterminant;
+    result[3] = (c * h - b * i) * inverseDeterminant;
+    result[6] = (b * f - c * e) * inverseDeterminant;
+    result[1] = (f * g - d * i) * inverseDeterminant;
+    result[4] = (a * i - c * g) * inverseDeterminant;
+    result[7] = (c * d - a * f) * inverseDeterminant;
+    result[2] = (d * h - e * g) * inverseDeterminant;
+    result[5] = (b * g - a * h) * inverseDeterminant;
+    result[8] = (a * e - b * d) * inverseDeterminant;
+    for (size_t row = 0; row < 3; ++row) {
+        result[9 + row] = -(result[row] * m[12] + result[3 + row] * m[13] + result[6 + row] * m[14]);
+    }
+    return result;
+}
+
+std::array<float, 3> transformPoint(const std::array<float, 12>& m, const std::array<float, 3>& p) {
+    return {
+        m[0] * p[0] + m[3] * p[1] + m[6] * p[2] + m[9],
+        m[1] * p[0] + m[4] * p[1] + m[7] * p[2] + m[10],
+        m[2] * p[0] + m[5] * p[1] + m[8] * p[2] + m[11]
+    };
+}
+
+std::array<float, 3> transformVector(const std::array<float, 12>& m, const std::array<float, 3>& v) {
+    return {
+        m[0] * v[0] + m[3] * v[1] + m[6] * v[2],
+        m[1] * v[0] + m[4] * v[1] + m[7] * v[2],
+        m[2] * v[0] + m[5] * v[1] + m[8] * v[2]
+    };
+}
+
+Bounds transformBounds(const Bounds& bounds, const std::array<float, 16>& m) {
+    Bounds result = EMPTY_BOUNDS;
+    if (bounds[0] > bounds[3]) {
+        return result;
+    }
+    for (int corner = 0; corner < 8; ++corner) {
+        const float x = bounds[(corner & 1) ? 3 : 0];
+        const float y = bounds[(corner & 2) ? 4 : 1];
+        const float z = bounds[(corner & 4) ? 5 : 2];
+        const std::array<float, 3> p = {
+            m[0] * x + m[4] * y + m[8] * z + m[12],
+            m[1] * x + m[5] * y + m[9] * z + m[13],
+            m[2] * x + m[6] * y + m[10] * z + m[14]
+        };
+        for (size_t axis = 0; axis < 3; ++axis) {
+            result[axis] = std::min(result[axis], p[axis]);
+            result[axis + 3] = std::max(result[axis + 3], p[axis]);
+        }
+    }
+    return result;
+}
+
+// Moller-Trumbore, returns the distance along the ray or a negative value
+float intersectTriangle(
+    const std::array<float, 3>& origin,
+    const std::array<float, 3>& direction,
+    const std::array<float, 3>& v0,
+    const std::array<float, 3>& v1,
+    const std::array<float, 3>& v2
+) {
+    const std::array<float, 3> edge1 = { v1[0] - v0[0], v1[1] - v0[1], v1[2] - v0[2] };
+    const std::array<float, 3> edge2 = { v2[0] - v0[0], v2[1] - v0[1], v2[2] - v0[2] };
+    const std::array<float, 3> p = {
+        direction[1] * edge2[2] - direction[2] * edge2[1],
+        direction[2] * edge2[0] - direction[0] * edge2[2],
+        direction[0] * edge2[1] - direction[1] * edge2[0]
+    };
+    const float determinant = edge1[0] * p[0] + edge1[1] * p[1] + edge1[2] * p[2];
+    if (std::abs(determinant) < 1e-12f) {
+        return -1.0f; // parallel or degenerate
+    }
+    const float inverseDeterminant = 1.0f / determinant;
+    const std::array<float, 3> s = { origin[0] - v0[0], origin[1] - v0[1], origin[2] - v0[2] };
+    const float u = (s[0] * p[0] + s[1] * p[1] + s[2] * p[2]) * inverseDeterminant;
+    if (u < 0.0f || u > 1.0f) {
+        return -1.0f;
+    }
+    const std::array<float, 3> q = {
+        s[1] * edge1[2] - s[2] * edge1[1],
+        s[2] * edge1[0] - s[0] * edge1[2],
+        s[0] * edge1[1] - s[1] * edge1[0]
+    };
+    const float v = (direction[0] * q[0] + direction[1] * q[1] + direction[2] * q[2]) * inverseDeterminant;
+    if (v < 0.0f || u + v > 1.0f) {
+        return -1.0f;
+    }
+    return (edge2[0] * q[0] + edge2[1] * q[1] + edge2[2] * q[2]) * inverseDeterminant;
+}
+
+// intersectTriangle for the lanes of a packet, returns a bit mask of the lanes hitting within their tMax
+int intersectTrianglePacket(
+    const RayPacket& packet,
+    const std::array<float, RayPacket::SIZE>& tMax,
+    const std::array<float, 3>& v0,
+    const std::array<float, 3>& v1,
+    const std::array<float, 3>& v2,
+    std::array<float, RayPacket::SIZE>& distances
+) {
+#ifdef __wasm_simd128__
+    std::array<v128_t, 3> edge1, edge2, s, direction;
+    for (size_t axis = 0; axis < 3; ++axis) {
+        edge1[axis] = wasm_f32x4_splat(v1[axis] - v0[axis]);
+        edge2[axis] = wasm_f32x4_splat(v2[axis] - v0[axis]);
+        s[axis] = wasm_f32x4_sub(wasm_v128_load(packet.origin[axis].data()), wasm_f32x4_splat(v0[axis]));
+        direction[axis] = wasm_v128_load(packet.direction[axis].data());
+    }
+    auto cross = [](const std::array<v128_t, 3>& a, const std::array<v128_t, 3>& b, size_t axis) {
+        const size_t i = (axis + 1) % 3;
+        const size_t j = (axis + 2) % 3;
+        return wasm_f32x4_sub(wasm_f32x4_mul(a[i], b[j]), wasm_f32x4_mul(a[j], b[i]));
+    };
+    auto dot = [](const std::array<v128_t, 3>& a, const std::array<v128_t, 3>& b) {
+        return wasm_f32x4_add(wasm_f32x4_add(wasm_f32x4_mul(a[0], b[0]), wasm_f32x4_mul(a[1], b[1])), wasm_f32x4_mul(a[2], b[2]));
+    };
+
+    const std::array<v128_t, 3> p = { cross(direction, edge2, 0), cross(direction, edge2, 1), cross(direction, edge2, 2) };
+    const std::array<v128_t, 3> q = { cross(s, edge1, 0), cross(s, edge1, 1), cross(s, edge1, 2) };
+    const v128_t determinant = dot(edge1, p);
+    const v128_t inverseDeterminant = wasm_f32x4_div(wasm_f32x4_splat(1.0f), determinant);
+    const v128_t u = wasm_f32x4_mul(dot(s, p), inverseDeterminant);
+    const v128_t v = wasm_f32x4_mul(dot(direction, q), inverseDeterminant);
+    const v128_t t = wasm_f32x4_mul(dot(edge2, q), inverseDeterminant);
+
+    const v128_t zero = wasm_f32x4_splat(0.0f);
+    const v128_t one = wasm_f32x4_splat(1.0f);
+    v128_t hit = wasm_f32x4_ge(wasm_f32x4_abs(determinant), wasm_f32x4_splat(1e-12f));
+    hit = wasm_v128_and(hit, wasm_v128_and(wasm_f32x4_ge(u, zero), wasm_f32x4_le(u, one)));
+    hit = wasm_v128_and(hit, wasm_v128_and(wasm_f32x4_ge(v, zero), wasm_f32x4_le(wasm_f32x4_add(u, v), one)));
+    hit = wasm_v128_and(hit, wasm_v128_and(wasm_f32x4_ge(t, zero), wasm_f32x4_lt(t, wasm_v128_load(tMax.data()))));
+    wasm_v128_store(distances.data(), t);
+    return static_cast<int>(wasm_i32x4_bitmask(hit));
+#else
+    int mask = 0;
+    for (size_t lane = 0; lane < RayPacket::SIZE; ++lane) {
+        distances[lane] = intersectTriangle(packet.getOrigin(lane), packet.getDirection(lane), v0, v1, v2);
+        if (distances[lane] >= 0.0f && distances[lane] < tMax[lane]) {
+            mask |= 1 << lane;
+        }
+    }
+    return mask;
+#endif
+}
+
+} // namespace
+
+ModelRaycaster::ModelRaycaster(TriangulatedModel& model)
+    : model(model)
+    , geometryBvhs(model.getTriCount())
+{
+#ifdef __EMSCRIPTEN_PTHREADS__
+    TaskScheduler::instance().parallelFor(geometryBvhs.size(), [this](size_t index) {
+        buildGeometryBvh(index);
+    });
+#else
+    for (size_t index = 0; index < geometryBvhs.size(); ++index) {
+        buildGeometryBvh(index);
+    }
+#endif
+
+    std::vector<Bounds> instanceBounds;
+    for (size_t meshIndex = 0; meshIndex < model.getMeshCount(); ++meshIndex) {
+        const Mesh& mesh = model.getMesh(meshIndex);
+        const int triGeometryIndex = mesh.getTriGeometryIndex();
+        if (triGeometryIndex < 0) {
+            continue;
+        }
+        const std::array<float, 16>& worldTransform = mesh.getWorldTransformData();
+        instances.push_back({
+            static_cast<uint32_t>(meshIndex),
+            static_cast<uint32_t>(triGeometryIndex),
+            invertAffine(worldTransform)
+        });
+        instanceBounds.push_back(transformBounds(model.getTri(static_cast<size_t>(triGeometryIndex)).bounds, worldTransform));
+    }
+    topLevelBvh.build(instanceBounds);
+}
+
+void ModelRaycaster::buildGeometryBvh(size_t triGeometryIndex) {
+    const TriGeometry& geometry = model.getTri(triGeometryIndex);
+    GeometryBvh& geometryBvh = geometryBvhs[triGeometryIndex];
+
+    const size_t triangleCount = geometry.getIndexCount() / 3;
+    std::vector<Bounds> triangleBounds(triangleCount);
+    for (size_t t = 0; t < triangleCount; ++t) {
+        Bounds& bounds = triangleBounds[t];
+        bounds = EMPTY_BOUNDS;
+        for (size_t k = 0; k < 3; ++k) {
+            const std::array<float, 3> position = geometry.getVertexPosition(geometry.indexAt(t * 3 + k));
+            for (size_t axis = 0; axis < 3; ++axis) {
+                bounds[axis] = std::min(bounds[axis], position[axis]);
+                bounds[axis + 3] = std::max(bounds[axis + 3], position[axis]);
+            }
+        }
+    }
+    geometryBvh.bvh.build(triangleBounds);
+
+    uint32_t triangleStart = 0;
+    geometryBvh.faceTriangleStarts.reserve(geometry.subMeshIndexCounts.size());
+    for (uint32_t faceIndexCount : geometry.subMeshIndexCounts) {
+        geometryBvh.faceTriangleStarts.push_back(triangleStart);
+        triangleStart += faceIndexCount / 3;
+    }
+}
+
+int ModelRaycaster::findFaceIndex(uint32_t triGeometryIndex, uint32_t triangle) const {
+    const std::vector<uint32_t>& faceTriangleStarts = geometryBvhs[triGeometryIndex].faceTriangleStarts;
+    const auto faceIt = std::upper_bound(faceTriangleStarts.begin(), faceTriangleStarts.end(), triangle);
+    return static_cast<int>(faceIt - faceTriangleStarts.begin()) - 1;
+}
+
+std::optional<RaycastHit> ModelRaycaster::raycast(const std::array<float, 3>& origin, const std::array<float, 3>& direction, float maxDistance) const {
+    const float length = std::sqrt(direction[0] * direction[0] + direction[1] * direction[1] + direction[2] * direction[2]);
+    if (length == 0.0f) {
+        return std::nullopt;
+    }
+    const std::array<float, 3> unitDirection = { direction[0] / length, direction[1] / length, direction[2] / length };
+
+    std::optional<RaycastHit> hit;
+    float tMax = maxDistance;
+    topLevelBvh.traverse(origin, unitDirection, tMax, [&](uint32_t instanceIndex, float& instanceTMax) {
+        const Instance& instance = instances[instanceIndex];
+        const TriGeometry& geometry = model.getTri(instance.triGeometryIndex);
+        const GeometryBvh& geometryBvh = geometryBvhs[instance.triGeometryIndex];
+
+        // the ray parameter is the same in both spaces, as the local direction is not normalized
+        const std::array<float, 3> localOrigin = transformPoint(instance.worldToLocal, origin);
+        const std::array<float, 3> localDirection = transformVector(instance.worldToLocal, unitDirection);
+        geometryBvh.bvh.traverse(localOrigin, localDirection, instanceTMax, [&](uint32_t triangle, float& triangleTMax) {
+            const float t = intersectTriangle(
+                localOrigin, localDirection,
+                geometry.getVertexPosition(geometry.indexAt(triangle * 3)),
+                geometry.getVertexPosition(geometry.indexAt(triangle * 3 + 1)),
+                geometry.getVertexPosition(geometry.indexAt(triangle * 3 + 2)));
+            if (t < 0.0f || t >= triangleTMax) {
+                return;
+            }
+            triangleTMax = t;
+
+            hit = RaycastHit{
+                static_cast<int>(instance.meshIndex),
+                findFaceIndex(instance.triGeometryIndex, triangle),
+                static_cast<int>(triangle),
+                t,
+                {
+                    origin[0] + unitDirection[0] * t,
+                    origin[1] + unitDirection[1] * t,
+                    origin[2] + unitDirection[2] * t
+                }
+            };
+        });
+    });
+    return hit;
+}
+
+void ModelRaycaster::raycastMany(const float* origins, const float* directions, size_t rayCount, RaycastBatch& batch) const {
+    // enough rays per job to outweigh the scheduling
+    constexpr size_t RAYS_PER_JOB = 256;
+
+    const size_t jobCount = (rayCount + RAYS_PER_JOB - 1) / RAYS_PER_JOB;
+    auto runJob = [&](size_t job) {
+        const size_t jobEnd = std::min(rayCount, (job + 1) * RAYS_PER_JOB);
+        for (size_t firstRay = job * RAYS_PER_JOB; firstRay < jobEnd; firstRay += RayPacket::SIZE) {
+            raycastPacket(origins, directions, firstRay, std::min(RayPacket::SIZE, jobEnd - firstRay), batch);
+        }
+    };
+#ifdef __EMSCRIPTEN_PTHREADS__
+    TaskScheduler::instance().parallelFor(jobCount, runJob);
+#else
+    for (size_t job = 0; job < jobCount; ++job) {
+        runJob(job);
+    }
+#endif
+}
+
+void ModelRaycaster::raycastPacket(const float* origins, const float* directions, size_t firstRay, size_t rayCount, RaycastBatch& batch) const {
+    RayPacket packet;
+    std::array<float, RayPacket::SIZE> tMax;
+    for (size_t lane = 0; lane < RayPacket::SIZE; ++lane) {
+        std::array<float, 3> origin = { 0.0f, 0.0f, 0.0f };
+        std::array<float, 3> direction = { 1.0f, 1.0f, 1.0f }; // keeps unused lanes finite
+        tMax[lane] = -1.0f;
+        if (lane < rayCount) {
+            const size_t ray = firstRay + lane;
+            const float* rayDirection = directions + ray * 3;
+            const float length = std::sqrt(rayDirection[0] * rayDirection[0] + rayDirection[1] * rayDirection[1] + rayDirection[2] * rayDirection[2]);
+            if (length > 0.0f) {
+                origin = { origins[ray * 3], origins[ray * 3 + 1], origins[ray * 3 + 2] };
+                direction = { rayDirection[0] / length, rayDirection[1] / length, rayDirection[2] / length };
+                tMax[lane] = std::numeric_limits<float>::max();
+            }
+        }
+        packet.setRay(lane, origin, direction);
+    }
+
+    constexpr uint32_t NO_HIT = std::numeric_limits<uint32_t>::max();
+    std::array<uint32_t, RayPacket::SIZE> hitInstances;
+    std::array<uint32_t, RayPacket::SIZE> hitTriangles;
+    hitInstances.fill(NO_HIT);
+    topLevelBvh.traversePacket(packet, tMax, [&](uint32_t instanceIndex, std::array<float, RayPacket::SIZE>& instanceTMax) {
+        const Instance& instance = instances[instanceIndex];
+        const TriGeometry& geometry = model.getTri(instance.triGeometryIndex);
+
+        RayPacket localPacket;
+        for (size_t lane = 0; lane < RayPacket::SIZE; ++lane) {
+            localPacket.setRay(
+                lane,
+                transformPoint(instance.worldToLocal, packet.getOrigin(lane)),
+                transformVector(instance.worldToLocal, packet.getDirection(lane)));
+        }
+        geometryBvhs[instance.triGeometryIndex].bvh.traversePacket(localPacket, instanceTMax, [&](uint32_t triangle, std::array<float, RayPacket::SIZE>& triangleTMax) {
+            std::array<float, RayPacket::SIZE> distances;
+            const int mask = intersectTrianglePacket(
+                localPacket, triangleTMax,
+                geometry.getVertexPosition(geometry.indexAt(triangle * 3)),
+                geometry.getVertexPosition(geometry.indexAt(triangle * 3 + 1)),
+                geometry.getVertexPosition(geometry.indexAt(triangle * 3 + 2)),
+                distances);
+            for (size_t lane = 0; lane < RayPacket::SIZE; ++lane) {
+                if (mask & (1 << lane)) {
+                    triangleTMax[lane] = distances[lane];
+                    hitInstances[lane] = instanceIndex;
+                    hitTriangles[lane] = triangle;
+                }
+            }
+        });
+    });
+
+    for (size_t lane = 0; lane < rayCount; ++lane) {
+        if (hitInstances[lane] == NO_HIT) {
+            continue;
+        }
+        const size_t ray = firstRay + lane;
+        const Instance& instance = instances[hitInstances[lane]];
+        batch.meshIndices[ray] = static_cast<int32_t>(instance.meshIndex);
+        batch.faceIndices[ray] = findFaceIndex(instance.triGeometryIndex, hitTriangles[lane]);
+        batch.triangleIndices[ray] = static_cast<int32_t>(hitTriangles[lane]);
+        batch.distances[ray] = tMax[lane];
+        for (size_t axis = 0; axis < 3; ++axis) {
+            batch.points[ray * 3 + axis] = packet.origin[axis][lane] + packet.direction[axis][lane] * tMax[lane];
+        }
+    }
+}
+
+// RaycastBatch methods
+
+size_t RaycastBatch::getRayCount() const {
+    return distances.size();
+}
+
+Int32Array RaycastBatch::getMeshIndices() const {
+    emscripten::memory_view view(meshIndices.size(), reinterpret_cast<const int32_t*>(meshIndices.data()));
+    return Int32Array(emscripten::val(view));
+}
+
+Int32Array RaycastBatch::getFaceIndices() const {
+    emscripten::memory_view view(faceIndices.size(), reinterpret_cast<const int32_t*>(faceIndices.data()));
+    return Int32Array(emscripten::val(view));
+}
+
+Int32Array RaycastBatch::getTriangleIndices() const {
+    emscripten::memory_view view(triangleIndices.size(), reinterpret_cast<const int32_t*>(triangleIndices.data()));
+    return Int32Array(emscripten::val(view));
+}
+
+Float32Array RaycastBatch::getDistances() const {
+    emscripten::memory_view view(distances.size(), reinterpret_cast<const float*>(distances.data()));
+    return Float32Array(emscripten::val(view));
+}
+
+Float32Array RaycastBatch::getPoints() const {
+    emscripten::memory_view view(points.size(), reinterpret_cast<const float*>(points.data()));
+    return Float32Array(emscripten::val(view));
+}
+
+EMSCRIPTEN_BINDINGS(model_raycaster_module) {
+    emscripten::value_array<std::array<float, 3>>("Vector3")
+        .element(emscripten::index<0>())
+        .element(emscripten::index<1>())
+        .element(emscripten::index<2>());
+
+    emscripten::value_object<RaycastHit>("RaycastHit")
+        .field("meshIndex", &RaycastHit::meshIndex)
+        .field("faceIndex", &RaycastHit::faceIndex)
+        .field("triangleIndex", &RaycastHit::triangleIndex)
+        .field("distance", &RaycastHit::distance)
+        .field("point", &RaycastHit::point);
+
+    emscripten::register_optional<RaycastHit>();
+
+    emscripten::class_<RaycastBatch>("RaycastBatch")
+        .function("getRayCount", &RaycastBatch::getRayCount)
+        .function("getMeshIndices", &RaycastBatch::getMeshIndices)
+        .function("getFaceIndices", &RaycastBatch::getFaceIndices)
+        .function("getTriangleIndices", &RaycastBatch::getTriangleIndices)
+        .function("getDistances", &RaycastBatch::getDistances)
+        .function("getPoints", &RaycastBatch::getPoints);
+}
@@ -0,0 +1,49 @@
+// Copyright (c) 2025 SolverX Corporation
+// This file is part of MIE OpenCascade WebAssembly Bindings.
+//
+// This library is free software; you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License version 2.1 as published
+// by the Free Software Foundation.
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "bvh.hpp"
+#include "model_context.hpp"
+
+// ray queries against a triangulated model: a BVH per tri geometry and a top-level BVH over the meshes using them
+class ModelRaycaster {
+private:
+    struct GeometryBvh {
+        Bvh bvh; // over triangles
+        std::vector<uint32_t> faceTriangleStarts; // first triangle of each face, from subMeshIndexCounts
+    };
+    struct Instance {
+        uint32_t meshIndex;
+        uint32_t triGeometryIndex;
+        std::array<float, 12> worldToLocal; // column-major 3x4
+    };
+
+    TriangulatedModel& model;
+    std::vector<GeometryBvh> geometryBvhs;
+    std::vector<Instance> instances;
+    Bvh topLevelBvh; // over instances
+
+public:
+    // the model must outlive the raycaster and keep its geometries
+    explicit ModelRaycaster(TriangulatedModel& model);
+
+    // nearest hit within maxDistance, both faces of the triangles are hit
+    std::optional<RaycastHit> raycast(const std::array<float, 3>& origin, const std::array<float, 3>& direction, float maxDistance) const;
+    // rays are traced in packets of four, the batch must hold rayCount entries
+    void raycastMany(const float* origins, const float* directions, size_t rayCount, RaycastBatch& batch) const;
+
+private:
+    void buildGeometryBvh(size_t triGeometryIndex);
+    int findFaceIndex(uint32_t triGeometryIndex, uint32_t triangle) const;
+    void raycastPacket(const float* origins, const float* directions, size_t firstRay, size_t rayCount, RaycastBatch& batch) const;
+};
@@ -0,0 +1,592 @@
+// Copyright (c) 2025 SolverX Corporation
+// This file is part of MIE OpenCascade WebAssembly Bindings.
+//
+// This library is free software; you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License version 2.1 as published
+// by the Free Software Foundation.
+
+#include "model_serialization.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "mesh_optimizer.hpp"
+
+namespace {
+
+constexpr std::array<char, 4> MAGIC = { 'M', 'I', 'E', 'T' };
+constexpr std::array<char, 4> SHAPE_ENTRY_MAGIC = { 'M', 'I', 'E', 'S' };
+constexpr size_t ARRAY_ALIGNMENT = 8;
+
+// smallest stored size of each element, so that counts are bounded by the remaining bytes.
+// a geometry holds its layout, its index format, 13 array counts and its fixed-size arrays.
+constexpr size_t MINIMAL_TRI_GEOMETRY_SIZE = 2 * sizeof(uint32_t) + 13 * sizeof(uint64_t)
+    + sizeof(std::array<float, 16>) + sizeof(Bounds) + sizeof(BoundingSphere);
+constexpr size_t MINIMAL_LINE_GEOMETRY_SIZE = 2 * sizeof(uint64_t) + sizeof(Bounds) + sizeof(BoundingSphere);
+constexpr size_t MINIMAL_POINT_GEOMETRY_SIZE = sizeof(uint64_t) + sizeof(Bounds) + sizeof(BoundingSphere);
+constexpr size_t MINIMAL_MESH_SIZE = sizeof(uint64_t) + 2 * sizeof(std::array<float, 16>) + sizeof(Bounds)
+    + sizeof(uint32_t) + 5 * sizeof(int32_t);
+constexpr size_t MINIMAL_MATERIAL_BATCH_SIZE = sizeof(int32_t) + 5 * sizeof(uint64_t);
+
+// writes to out, or only measures the size when out is null
+class Writer {
+private:
+    uint8_t* out;
+    size_t offset = 0;
+
+public:
+    explicit Writer(uint8_t* out = nullptr)
+        : out(out)
+    {
+    }
+
+    size_t getSize() const { return offset; }
+
+    void writeBytes(const void* data, size_t size) {
+        if (out != nullptr && size > 0) {
+            std::memcpy(out + offset, data, size);
+        }
+        offset += size;
+    }
+
+    void align(size_t alignment) {
+        const size_t padding = (alignment - offset % alignment) % alignment;
+        if (out != nullptr) {
+            std::memset(out + offset, 0, padding);
+        }
+        offset += padding;
+    }
+
+    template <typename T>
+    void writeValue(T value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        writeBytes(&value, sizeof(T));
+    }
+
+    template <typename T, size_t N>
+    void writeFixedArray(const std::array<T, N>& values) {
+        writeBytes(values.data(), sizeof(T) * N);
+    }
+
+    template <typename T>
+    void writeArray(const std::vector<T>& values) {
+        writeValue<uint64_t>(values.size());
+        align(ARRAY_ALIGNMENT);
+        writeBytes(values.data(), values.size() * sizeof(T));
+    }
+
+    void writeString(const std::string& value) {
+        writeValue<uint64_t>(value.size());
+        writeBytes(value.data(), value.size());
+    }
+};
+
+// bounds-checked reads, every read fails once one has failed
+class Reader {
+private:
+    const uint8_t* data;
+    size_t size;
+    size_t offset = 0;
+    bool failed = false;
+
+public:
+    Reader(const uint8_t* data, size_t size)
+        : data(data)
+        , size(size)
+    {
+    }
+
+    bool hasFailed() const { return failed; }
+    bool isAtEnd() const { return offset == size; }
+    size_t getRemainingSize() const { return size - offset; }
+
+    bool readBytes(void* target, size_t byteCount) {
+        if (failed || byteCount > size - offset) {
+            failed = true;
+            return false;
+        }
+        if (byteCount > 0) {
+            std::memcpy(target, data + offset, byteCount);
+        }
+        offset += byteCount;
+        return true;
+    }
+
+    bool align(size_t alignment) {
+        const size_t padding = (alignment - offset % alignment) % alignment;
+        if (failed || padding > size - offset) {
+            failed = true;
+            return false;
+        }
+        offset += padding;
+        return true;
+    }
+
+    template <typename T>
+    T readValue() {
+        static_assert(std::is_trivially_copyable_v<T>);
+        T value {};
+        readBytes(&value, sizeof(T));
+        return value;
+    }
+
+    template <typename T, size_t N>
+    void readFixedArray(std::array<T, N>& values) {
+        readBytes(values.data(), sizeof(T) * N);
+    }
+
+    template <typename T>
+    void readArray(std::vector<T>& values) {
+        const uint64_t count = readValue<uint64_t>();
+        if (!align(ARRAY_ALIGNMENT) || count > (size - offset) / sizeof(T)) {
+            failed = true;
+            return;
+        }
+        values.resize(static_cast<size_t>(count));
+        readBytes(values.data(), values.size() * sizeof(T));
+    }
+
+    void readString(std::string& value) {
+        const uint64_t length = readValue<uint64_t>();
+        if (failed || length > size - offset) {
+            failed = true;
+            return;
+        }
+        value.assign(reinterpret_cast<const char*>(data + offset), static_cast<size_t>(length));
+        offset += static_cast<size_t>(length);
+    }
+
+    // an element count, bounded by the remaining bytes so that a corrupted count does not allocate
+    size_t readCount(size_t minimalElementSize) {
+        const uint64_t count = readValue<uint64_t>();
+        if (failed || count > (size - offset) / minimalElementSize) {
+            failed = true;
+            return 0;
+        }
+        return static_cast<size_t>(count);
+    }
+};
+
+void writeTriGeometry(Writer& writer, const TriGeometry& geometry) {
+    writer.writeValue<uint32_t>(static_cast<uint32_t>(geometry.layout));
+    writer.writeArray(geometry.positions);
+    writer.writeArray(geometry.normals);
+    writer.writeArray(geometry.uvs);
+    writer.writeArray(geometry.vertices);
+    writer.writeArray(geometry.quantizedVertices);
+    writer.writeFixedArray(geometry.dequantizationMatrix);
+    writer.writeValue<uint32_t>(static_cast<uint32_t>(geometry.indexFormat));
+    writer.writeArray(geometry.indices);
+    writer.writeArray(geometry.indices16);
+    writer.writeArray(geometry.subMeshIndices);
+    writer.writeArray(geometry.subMeshIndexCounts);
+    writer.writeArray(geometry.meshlets);
+    writer.writeArray(geometry.meshletVertices);
+    writer.writeArray(geometry.meshletTriangles);
+    writer.writeArray(geometry.meshletBounds);
+    writer.writeFixedArray(geometry.bounds);
+    writer.writeFixedArray(geometry.boundingSphere);
+}
+
+// a geometry reference of a mesh, -1 or a valid index
+bool isValidReference(int32_t index, size_t count) {
+    return index >= -1 && (index < 0 || static_cast<size_t>(index) < count);
+}
+
+template <typename Index>
+bool areIndicesBelow(const std::vector<Index>& indices, size_t count) {
+    return std::all_of(indices.begin(), indices.end(), [count](Index index) { return index < count; });
+}
+
+uint64_t sumCounts(const std::vector<uint32_t>& counts) {
+    return std::accumulate(counts.begin(), counts.end(), uint64_t(0));
+}
+
+// start + count <= size, without overflowing
+bool isValidRange(uint64_t start, uint64_t count, size_t size) {
+    return start <= size && count <= size - start;
+}
+
+// the invariants the accessors rely on, so that a corrupted buffer can not make them read out of the arrays
+bool isValidTriGeometry(const TriGeometry& geometry) {
+    const size_t vertexCount = geometry.getVertexCount();
+    switch (geometry.layout) {
+    case VertexLayout::Separate:
+        if (geometry.positions.size() != vertexCount * 3 || geometry.normals.size() != vertexCount * 3
+            || geometry.uvs.size() != vertexCount * 2 || !geometry.vertices.empty() || !geometry.quantizedVertices.empty()) {
+            return false;
+        }
+        break;
+    case VertexLayout::Interleaved:
+        if (geometry.vertices.size() != vertexCount * TriGeometry::INTERLEAVED_STRIDE || !geometry.positions.empty()
+            || !geometry.normals.empty() || !geometry.uvs.empty() || !geometry.quantizedVertices.empty()) {
+            return false;
+        }
+        break;
+    case VertexLayout::Quantized:
+        if (geometry.quantizedVertices.size() != vertexCount * TriGeometry::QUANTIZED_STRIDE || !geometry.positions.empty()
+            || !geometry.normals.empty() || !geometry.uvs.empty() || !geometry.vertices.empty()) {
+            return false;
+        }
+        break;
+    }
+
+    const size_t indexCount = geometry.getIndexCount();
+    const bool hasUnusedIndices = geometry.indexFormat == IndexFormat::Uint16 ? !geometry.indices.empty() : !geometry.indices16.empty();
+    if (hasUnusedIndices || indexCount % 3 != 0
+        || !areIndicesBelow(geometry.indices, vertexCount) || !areIndicesBelow(geometry.indices16, vertexCount)) {
+        return false;
+    }
+    // faces partition the vertices and the indices
+    if (geometry.subMeshIndices.size() != geometry.subMeshIndexCounts.size()
+        || sumCounts(geometry.subMeshIndices) != vertexCount || sumCounts(geometry.subMeshIndexCounts) != indexCount) {
+        return false;
+    }
+
+    const size_t meshletCount = geometry.meshlets.size() / MeshOptimizer::MESHLET_STRIDE;
+    if (geometry.meshlets.size() % MeshOptimizer::MESHLET_STRIDE != 0
+        || geometry.meshletBounds.size() != meshletCount * MeshOptimizer::MESHLET_BOUNDS_STRIDE
+        || geometry.meshletTriangles.size() % 3 != 0
+        || !areIndicesBelow(geometry.meshletVertices, vertexCount)) {
+        return false;
+    }
+    for (size_t i = 0; i < meshletCount; ++i) {
+        const uint32_t* meshlet = geometry.meshlets.data() + i * MeshOptimizer::MESHLET_STRIDE;
+        const uint32_t vertexOffset = meshlet[0];
+        const uint32_t triangleOffset = meshlet[1];
+        const uint32_t meshletVertexCount = meshlet[2];
+        const uint32_t triangleCount = meshlet[3];
+        if (!isValidRange(vertexOffset, meshletVertexCount, geometry.meshletVertices.size())
+            || !isValidRange(triangleOffset, triangleCount, geometry.meshletTriangles.size() / 3)) {
+            return false;
+        }
+        const auto triangles = geometry.meshletTriangles.begin() + static_cast<std::ptrdiff_t>(triangleOffset) * 3;
+        if (!std::all_of(triangles, triangles + static_cast<std::ptrdiff_t>(triangleCount) * 3,
+                [meshletVertexCount](uint8_t vertex) { return vertex < meshletVertexCount; })) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool isValidLineGeometry(const LineGeometry& geometry) {
+    return geometry.positions.size() % 3 == 0 && sumCounts(geometry.subMeshIndices) == geometry.positions.size() / 3;
+}
+
+bool isValidMaterialBatch(const MaterialBatch& batch, size_t materialCount, size_t meshCount) {
+    const size_t vertexCount = batch.positions.size() / 3;
+    if (!isValidReference(batch.materialIndex, materialCount)
+        || batch.positions.size() % 3 != 0 || batch.normals.size() != batch.positions.size() || batch.uvs.size() != vertexCount * 2
+        || batch.indices.size() % 3 != 0 || !areIndicesBelow(batch.indices, vertexCount)
+        || batch.meshRanges.size() % MaterialBatch::MESH_RANGE_STRIDE != 0) {
+        return false;
+    }
+    for (size_t i = 0; i < batch.meshRanges.size(); i += MaterialBatch::MESH_RANGE_STRIDE) {
+        const uint32_t* range = batch.meshRanges.data() + i;
+        if (range[0] >= meshCount
+            || !isValidRange(range[1], range[2], batch.indices.size())
+            || !isValidRange(range[3], range[4], vertexCount)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool readTriGeometry(Reader& reader, TriGeometry& geometry) {
+    const uint32_t layout = reader.readValue<uint32_t>();
+    if (layout > static_cast<uint32_t>(VertexLayout::Quantized)) {
+        return false;
+    }
+    geometry.layout = static_cast<VertexLayout>(layout);
+    reader.readArray(geometry.positions);
+    reader.readArray(geometry.normals);
+    reader.readArray(geometry.uvs);
+    reader.readArray(geometry.vertices);
+    reader.readArray(geometry.quantizedVertices);
+    reader.readFixedArray(geometry.dequantizationMatrix);
+    const uint32_t indexFormat = reader.readValue<uint32_t>();
+    if (indexFormat > static_cast<uint32_t>(IndexFormat::Uint16)) {
+        return false;
+    }
+    geometry.indexFormat = static_cast<IndexFormat>(indexFormat);
+    reader.readArray(geometry.indices);
+    reader.readArray(geometry.indices16);
+    reader.readArray(geometry.subMeshIndices);
+    reader.readArray(geometry.subMeshIndexCounts);
+    reader.readArray(geometry.meshlets);
+    reader.readArray(geometry.meshletVertices);
+    reader.readArray(geometry.meshletTriangles);
+    reader.readArray(geometry.meshletBounds);
+    reader.readFixedArray(geometry.bounds);
+    reader.readFixedArray(geometry.boundingSphere);
+    return !reader.hasFailed() && isValidTriGeometry(geometry);
+}
+
+void writeModel(Writer& writer, TriangulatedModel& model) {
+    writer.writeFixedArray(MAGIC);
+    writer.writeValue<uint32_t>(ModelSerialization::FORMAT_VERSION);
+
+    const size_t lodCount = model.getLodCount();
+    writer.writeValue<uint64_t>(lodCount);
+    writer.writeValue<uint64_t>(model.getTriCount());
+    for (size_t i = 0; i < model.getTriCount(); ++i) {
+        for (size_t level = 0; level < lodCount; ++level) {
+            writeTriGeometry(writer, model.getTriLod(i, level));
+        }
+    }
+
+    writer.writeValue<uint64_t>(model.getLineCount());
+    for (size_t i = 0; i < model.getLineCount(); ++i) {
+        const LineGeometry& geometry = model.getLine(i);
+        writer.writeArray(geometry.positions);
+        writer.writeArray(geometry.subMeshIndices);
+        writer.writeFixedArray(geometry.bounds);
+        writer.writeFixedArray(geometry.boundingSphere);
+    }
+
+    writer.writeValue<uint64_t>(model.getPointCount());
+    for (size_t i = 0; i < model.getPointCount(); ++i) {
+        const PointGeometry& geometry = model.getPoint(i);
+        writer.writeArray(geometry.positions);
+        writer.writeFixedArray(geometry.bounds);
+        writer.writeFixedArray(geometry.boundingSphere);
+    }
+
+    writer.writeValue<uint64_t>(model.getMaterialCount());
+    for (size_t i = 0; i < model.getMaterialCount(); ++i) {
+        writer.writeFixedArray(model.getMaterial(i).getColorData());
+    }
+
+    writer.writeValue<uint64_t>(model.getMeshCount());
+    for (size_t i = 0; i < model.getMeshCount(); ++i) {
+        const Mesh& mesh = model.getMesh(i);
+        writer.writeString(mesh.getName());
+        writer.writeFixedArray(mesh.getTransformData());
+        writer.writeFixedArray(mesh.getWorldTransformData());
+        writer.writeFixedArray(mesh.getWorldBoundsData());
+        writer.writeValue<uint32_t>(static_cast<uint32_t>(mesh.getShapeType()));
+        writer.writeValue<int32_t>(mesh.getTriGeometryIndex());
+        writer.writeValue<int32_t>(mesh.getLineGeometryIndex());
+        writer.writeValue<int32_t>(mesh.getPointGeometryIndex());
+        writer.writeValue<int32_t>(mesh.getMaterialIndex());
+        writer.writeValue<int32_t>(mesh.getParentMeshIndex());
+    }
+
+    writer.writeValue<uint64_t>(model.getMaterialBatchCount());
+    for (size_t i = 0; i < model.getMaterialBatchCount(); ++i) {
+        const MaterialBatch& batch = model.getMaterialBatch(i);
+        writer.writeValue<int32_t>(batch.materialIndex);
+        writer.writeArray(batch.positions);
+        writer.writeArray(batch.normals);
+        writer.writeArray(batch.uvs);
+        writer.writeArray(batch.indices);
+        writer.writeArray(batch.meshRanges);
+    }
+}
+
+void writeShape(Writer& writer, const ModelSerialization::ShapeEntry& entry) {
+    writer.writeFixedArray(SHAPE_ENTRY_MAGIC);
+    writer.writeValue<uint32_t>(ModelSerialization::FORMAT_VERSION);
+
+    writer.writeValue<uint64_t>(entry.levels.size());
+    for (const TriGeometry& geometry : entry.levels) {
+        writeTriGeometry(writer, geometry);
+    }
+    writer.writeValue<uint64_t>(entry.edgeLines.size());
+    for (const std::vector<float>& positions : entry.edgeLines) {
+        writer.writeArray(positions);
+    }
+    writer.writeArray(entry.vertexPoints);
+}
+
+} // namespace
+
+ByteBuffer ModelSerialization::writeShapeEntry(const ShapeEntry& entry) {
+    Writer sizeWriter;
+    writeShape(sizeWriter, entry);
+
+    ByteBuffer buffer(sizeWriter.getSize());
+    Writer writer(buffer.getData());
+    writeShape(writer, entry);
+    return buffer;
+}
+
+std::optional<ModelSerialization::ShapeEntry> ModelSerialization::readShapeEntry(const uint8_t* data, size_t size) {
+    Reader reader(data, size);
+    std::array<char, 4> magic;
+    reader.readFixedArray(magic);
+    const uint32_t version = reader.readValue<uint32_t>();
+    if (reader.hasFailed() || magic != SHAPE_ENTRY_MAGIC || version != FORMAT_VERSION) {
+        return std::nullopt;
+    }
+
+    ShapeEntry entry;
+    entry.levels.resize(reader.readCount(MINIMAL_TRI_GEOMETRY_SIZE));
+    for (TriGeometry& geometry : entry.levels) {
+        if (!readTriGeometry(reader, geometry)) {
+            return std::nullopt;
+        }
+    }
+    entry.edgeLines.resize(reader.readCount(sizeof(uint64_t)));
+    for (std::vector<float>& positions : entry.edgeLines) {
+        reader.readArray(positions);
+        if (positions.size() % 3 != 0) {
+            return std::nullopt;
+        }
+    }
+    reader.readArray(entry.vertexPoints);
+
+    if (reader.hasFailed() || !reader.isAtEnd() || entry.levels.empty()) {
+        return std::nullopt;
+    }
+    return entry;
+}
+
+ByteBuffer ModelSerialization::write(TriangulatedModel& model) {
+    Writer sizeWriter;
+    writeModel(sizeWriter, model);
+
+    ByteBuffer buffer(sizeWriter.getSize());
+    Writer writer(buffer.getData());
+    writeModel(writer, model);
+    return buffer;
+}
+
+std::optional<TriangulatedModel> ModelSerialization::read(const uint8_t* data, size_t size) {
+    Reader reader(data, size);
+    std::array<char, 4> magic;
+    reader.readFixedArray(magic);
+    const uint32_t version = reader.readValue<uint32_t>();
+    if (reader.hasFailed() || magic != MAGIC || version != FORMAT_VERSION) {
+        return std::nullopt;
+    }
+
+    // the count comes from TriangulationOptions::lodCount, an int
+    const uint64_t lodCount = reader.readValue<uint64_t>();
+    if (reader.hasFailed() || lodCount < 1 || lodCount > static_cast<uint64_t>(std::numeric_limits<int>::max())) {
+        return std::nullopt;
+    }
+    const size_t levelCount = static_cast<size_t>(lodCount);
+    // every tri geometry is stored at each level, checked by division so that the product can not overflow
+    const size_t triCount = reader.readCount(MINIMAL_TRI_GEOMETRY_SIZE);
+    if (triCount > 0 && levelCount > reader.getRemainingSize() / MINIMAL_TRI_GEOMETRY_SIZE / triCount) {
+        return std::nullopt;
+    }
+    std::vector<TriGeometry> tris(triCount);
+    std::vector<TriGeometry> lodTris(triCount * (levelCount - 1));
+    for (size_t i = 0; i < triCount; ++i) {
+        if (!readTriGeometry(reader, tris[i])) {
+            return std::nullopt;
+        }
+        for (size_t level = 1; level < levelCount; ++level) {
+            if (!readTriGeometry(reader, lodTris[i * (levelCount - 1) + (level - 1)])) {
+                return std::nullopt;
+            }
+        }
+    }
+
+    std::vector<LineGeometry> lines(reader.readCount(MINIMAL_LINE_GEOMETRY_SIZE));
+    for (LineGeometry& geometry : lines) {
+        reader.readArray(geometry.positions);
+        reader.readArray(geometry.subMeshIndices);
+        reader.readFixedArray(geometry.bounds);
+        reader.readFixedArray(geometry.boundingSphere);
+        if (!isValidLineGeometry(geometry)) {
+            return std::nullopt;
+        }
+    }
+
+    std::vector<PointGeometry> points(reader.readCount(MINIMAL_POINT_GEOMETRY_SIZE));
+    for (PointGeometry& geometry : points) {
+        reader.readArray(geometry.positions);
+        reader.readFixedArray(geometry.bounds);
+        reader.readFixedArray(geometry.boundingSphere);
+        if (geometry.positions.size() % 3 != 0) {
+            return std::nullopt;
+        }
+    }
+
+    const size_t materialCount = reader.readCount(sizeof(std::array<float, 3>));
+    std::vector<Material> materials;
+    materials.reserve(materialCount);
+    for (size_t i = 0; i < materialCount && !reader.hasFailed(); ++i) {
+        std::array<float, 3> color;
+        reader.readFixedArray(color);
+        materials.emplace_back(color);
+    }
+
+    const size_t meshCount = reader.readCount(MINIMAL_MESH_SIZE);
+    std::vector<Mesh> meshes;
+    meshes.reserve(meshCount);
+    for (size_t i = 0; i < meshCount && !reader.hasFailed(); ++i) {
+        std::string name;
+        std::array<float, 16> transform;
+        std::array<float, 16> worldTransform;
+        Bounds worldBounds;
+        reader.readString(name);
+        reader.readFixedArray(transform);
+        reader.readFixedArray(worldTransform);
+        reader.readFixedArray(worldBounds);
+        const uint32_t shapeType = reader.readValue<uint32_t>();
+        const int32_t triGeometryIndex = reader.readValue<int32_t>();
+        const int32_t lineGeometryIndex = reader.readValue<int32_t>();
+        const int32_t pointGeometryIndex = reader.readValue<int32_t>();
+        const int32_t materialIndex = reader.readValue<int32_t>();
+        const int32_t parentMeshIndex = reader.readValue<int32_t>();
+        // parents precede their children
+        if (shapeType > static_cast<uint32_t>(MeshShapeType::Unknown)
+            || !isValidReference(triGeometryIndex, tris.size())
+            || !isValidReference(lineGeometryIndex, lines.size())
+            || !isValidReference(pointGeometryIndex, points.size())
+            || !isValidReference(materialIndex, materials.size())
+            || !isValidReference(parentMeshIndex, i)) {
+            return std::nullopt;
+        }
+        meshes.emplace_back(
+            std::move(name),
+            transform,
+            worldTransform,
+            worldBounds,
+            static_cast<MeshShapeType>(shapeType),
+            triGeometryIndex,
+            lineGeometryIndex,
+            pointGeometryIndex,
+            materialIndex,
+            parentMeshIndex
+        );
+    }
+
+    std::vector<MaterialBatch> materialBatches(reader.readCount(MINIMAL_MATERIAL_BATCH_SIZE));
+    for (MaterialBatch& batch : materialBatches) {
+        batch.materialIndex = reader.readValue<int32_t>();
+        reader.readArray(batch.positions);
+        reader.readArray(batch.normals);
+        reader.readArray(batch.uvs);
+        reader.readArray(batch.indices);
+        reader.readArray(batch.meshRanges);
+        if (!isValidMaterialBatch(batch, materials.size(), meshes.size())) {
+            return std::nullopt;
+        }
+    }
+
+    if (reader.hasFailed() || !reader.isAtEnd()) {
+        return std::nullopt;
+    }
+    return TriangulatedModel(
+        std::move(tris),
+        std::move(lines),
+        std::move(points),
+        std::move(materials),
+        std::move(meshes),
+        std::move(lodTris),
+        static_cast<size_t>(lodCount),
+        std::move(materialBatches)
+    );
+}
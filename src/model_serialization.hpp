@@ -0,0 +1,40 @@
+// Copyright (c) 2025 SolverX Corporation
+// This file is part of MIE OpenCascade WebAssembly Bindings.
+//
+// This library is free software; you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License version 2.1 as published
+// by the Free Software Foundation.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "common.hpp"
+#include "model_context.hpp"
+
+// binary snapshot of a TriangulatedModel, to reopen a model without importing and meshing it again.
+// little-endian like wasm memory; arrays are stored as a uint64 count followed by their raw elements,
+// aligned to 8 bytes from the buffer start so that they can be viewed in place.
+class ModelSerialization {
+public:
+    static constexpr uint32_t FORMAT_VERSION = 1; // bumped on any layout change, older caches are rejected
+
+    // a triangulated solid or shell, as stored in a TriangulationCache.
+    // edges and vertices are in the traversal order of the shape, to match them with its sub-shapes again.
+    struct ShapeEntry {
+        std::vector<TriGeometry> levels; // finest level first
+        std::vector<std::vector<float>> edgeLines; // line segments per edge
+        std::vector<std::array<float, 3>> vertexPoints;
+    };
+
+    static ByteBuffer write(TriangulatedModel& model);
+    // returns std::nullopt for a truncated or malformed buffer, or another format version
+    static std::optional<TriangulatedModel> read(const uint8_t* data, size_t size);
+
+    static ByteBuffer writeShapeEntry(const ShapeEntry& entry);
+    static std::optional<ShapeEntry> readShapeEntry(const uint8_t* data, size_t size);
+};
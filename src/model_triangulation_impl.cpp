@@ -6,23 +6,43 @@
 // by the Free Software Foundation.
 
 #include "model_triangulation_impl.hpp"
+#include "content_hash.hpp"
+#include "mesh_optimizer.hpp"
+#include "model_serialization.hpp"
+#include "triangulation_cache.hpp"
+#ifdef __EMSCRIPTEN_PTHREADS__
+#include "task_scheduler.hpp"
 
+#include <emscripten/threading.h>
+#endif
+
+#include <algorithm>
 #include <array>
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <streambuf>
+#include <string>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
 #include <vector>
 
+#include <BinTools.hxx>
 #include <Bnd_Box.hxx>
 #include <BRepAdaptor_Curve.hxx>
 #include <BRepBndLib.hxx>
 #include <BRepLib_ToolTriangulatedShape.hxx>
 #include <BRepMesh_IncrementalMesh.hxx>
+#include <IMeshTools_Parameters.hxx>
 #include <BRepTools.hxx>
 #include <BRep_Tool.hxx>
 #include <GCPnts_TangentialDeflection.hxx>
 #include <gp_Trsf.hxx>
 #include <gp_Pnt.hxx>
+#include <Message_ProgressScope.hxx>
 #include <Poly_Triangulation.hxx>
 #include <Poly_PolygonOnTriangulation.hxx>
 #include <Prs3d.hxx>
@@ -44,10 +64,56 @@
 #include <TopoDS_Vertex.hxx>
 #include <TopTools_IndexedMapOfShape.hxx>
 
+// hashes the bytes written to it, so that a serialized shape is hashed without being kept in memory
+class HashingStreamBuf : public std::streambuf {
+private:
+    ContentHasher& hasher;
+    std::array<char, 4096> buffer;
+    std::streamoff position = 0; // bytes handed to the hasher
+
+public:
+    explicit HashingStreamBuf(ContentHasher& hasher)
+        : hasher(hasher)
+    {
+        setp(buffer.data(), buffer.data() + buffer.size());
+    }
+
+protected:
+    int_type overflow(int_type ch) override {
+        flushBuffer();
+        if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(ch);
+            pbump(1);
+        }
+        return traits_type::not_eof(ch);
+    }
+
+    int sync() override {
+        flushBuffer();
+        return 0;
+    }
+
+    // only reports the write position, for tellp
+    pos_type seekoff(off_type offset, std::ios_base::seekdir direction, std::ios_base::openmode mode) override {
+        if (offset != 0 || direction != std::ios_base::cur || (mode & std::ios_base::out) == 0) {
+            return pos_type(off_type(-1));
+        }
+        return pos_type(position + (pptr() - pbase()));
+    }
+
+private:
+    void flushBuffer() {
+        hasher.update(pbase(), static_cast<size_t>(pptr() - pbase()));
+        position += pptr() - pbase();
+        setp(buffer.data(), buffer.data() + buffer.size());
+    }
+};
+
 class TriangulationContext {
     struct TriGeometryInfo {
         Standard_Size id;
         TriGeometry geometry;
+        std::vector<TriGeometry> lodGeometries; // from level 1
     };
     struct LineGeometryInfo {
         Standard_Size id;
@@ -66,10 +132,34 @@ class TriangulationContext {
         Standard_Integer lineGeometryIndex;
         Standard_Integer pointGeometryIndex;
     };
+    // edges and vertices are keyed by TShape, to drop the ones shared with earlier shapes on registration
+    struct EdgeLines {
+        TopoDS_TShape* edge;
+        std::vector<float> positions; // line segments, empty if the edge produced none
+    };
+    struct VertexPoint {
+        TopoDS_TShape* vertex;
+        std::array<float, 3> position;
+    };
+    struct ShapeTriangulation {
+        bool completed = true; // false if cancelled while meshing
+        TriGeometry triData;
+        std::vector<EdgeLines> edgeLines;
+        std::vector<VertexPoint> vertexPoints;
+        std::vector<TriGeometry> lodTriData; // coarser levels of triData, from level 1
+    };
+    // keeps coarse levels from collapsing curved faces into a few triangles
+    static constexpr Standard_Real MAXIMAL_LOD_ANGLE_DEFLECTION = 0.8;
 
 private:
     Handle(XCAFDoc_ShapeTool) shapeTool;
     Handle(XCAFDoc_ColorTool) colorTool;
+    TriangulationOptions options;
+    Handle(TaskProgress) progress;
+    TriangulationCache* cache;
+    // false when the triangulation blocks the main runtime thread, where a promise from the cache never settles
+    bool waitForCache;
+    uint64_t optionsHash; // of the options which change the triangulation output, for cache keys
 
     // output data
     std::unordered_map<TopoDS_TShape*, TriGeometryInfo> triGeometryMap;
@@ -84,49 +174,109 @@ private:
     std::unordered_set<TopoDS_TShape*> processedEdgeSet;
     // for remove point duplication
     std::unordered_set<TopoDS_TShape*> processedPointSet;
+    // shapes triangulated ahead of the tree traversal, waiting for registration
+    std::unordered_map<TopoDS_TShape*, ShapeTriangulation> prebuiltShapeMap;
+    // shape of each tri geometry, for refinement
+    std::vector<TopoDS_Shape> triGeometryShapes;
 public:
     TriangulationContext(
         Handle(XCAFDoc_ShapeTool) shapeTool,
-        Handle(XCAFDoc_ColorTool) colorTool
+        Handle(XCAFDoc_ColorTool) colorTool,
+        const TriangulationOptions& options,
+        Handle(TaskProgress) progress,
+        TriangulationCache* cache = nullptr
     )        : shapeTool(shapeTool)
         , colorTool(colorTool)
+        , options(options)
+        , progress(progress)
+        , cache(cache)
+#ifdef __EMSCRIPTEN_PTHREADS__
+        , waitForCache(!emscripten_is_main_runtime_thread())
+#else
+        , waitForCache(false)
+#endif
+        , optionsHash(hashOptions(options))
     { }
 
-    TriangulatedModel compute() {
-        // build solid and edge shape ID maps
+    std::optional<TriangulatedModel> compute() {
+        std::vector<TopoDS_Shape> rootShapes;
         for (TDF_ChildIterator it(shapeTool->Label()); it.More(); it.Next()) {
             TDF_Label childLabel = it.Value();
             TopoDS_Shape shape;
             if (shapeTool->GetShape(childLabel, shape) && shapeTool->IsFree(childLabel)) {
                 // free shapes (root nodes)
-                resolveShapeTree(shape);
+                rootShapes.push_back(shape);
+            }
+        }
+
+        const std::vector<TopoDS_Shape> uniqueShapes = collectUniqueShapes(rootShapes);
+        progress->setPhase(TaskPhase::Triangulating, static_cast<uint32_t>(uniqueShapes.size()));
+        Message_ProgressScope progressScope(progress->Start(), "Triangulation", static_cast<Standard_Real>(std::max<size_t>(1, uniqueShapes.size())));
+
+#ifdef __EMSCRIPTEN_PTHREADS__
+        if (options.parallel && uniqueShapes.size() > 1) {
+            prebuildShapeTriangulations(uniqueShapes, progressScope);
+        }
+#endif
+
+        // build solid and edge shape ID maps
+        bool completed = true;
+        for (const TopoDS_Shape& shape : rootShapes) {
+            completed = resolveShapeTree(shape, progressScope);
+            if (!completed) {
+                break;
             }
         }
         
+        // children follow their parent in the mesh list
+        for (size_t i = meshes.size(); i-- > 0;) {
+            const int parentMeshIndex = meshes[i].getParentMeshIndex();
+            if (parentMeshIndex >= 0) {
+                meshes[static_cast<size_t>(parentMeshIndex)].expandWorldBounds(meshes[i].getWorldBoundsData());
+            }
+        }
+
         processedShapeMap.clear();
         processedEdgeSet.clear();
         processedPointSet.clear();
+        prebuiltShapeMap.clear();
+
+        // clean up triangulation data to save memory
+        for (const TopoDS_Shape& shape : rootShapes) {
+            BRepTools::Clean(shape, Standard_True);
+        }
 
+        if (!completed) {
+            triGeometryMap.clear();
+            lineGeometryMap.clear();
+            pointGeometryMap.clear();
+            materialMap.clear();
+            meshes.clear();
+            triGeometryShapes.clear();
+            return std::nullopt;
+        }
+
+        const size_t coarseLodCount = static_cast<size_t>(std::max(1, options.lodCount) - 1);
         std::vector<TriGeometry> tris(triGeometryMap.size());
-        for (const auto& [_, triInfo] : triGeometryMap) tris[triInfo.id] = std::move(triInfo.geometry);
+        std::vector<TriGeometry> lodTris(triGeometryMap.size() * coarseLodCount);
+        for (auto& [_, triInfo] : triGeometryMap) {
+            tris[triInfo.id] = std::move(triInfo.geometry);
+            std::move(triInfo.lodGeometries.begin(), triInfo.lodGeometries.end(), lodTris.begin() + triInfo.id * coarseLodCount);
+        }
         triGeometryMap.clear();
         std::vector<LineGeometry> lines(lineGeometryMap.size());
-        for (const auto& [_, lineInfo] : lineGeometryMap) lines[lineInfo.id] = std::move(lineInfo.geometry);
+        for (auto& [_, lineInfo] : lineGeometryMap) lines[lineInfo.id] = std::move(lineInfo.geometry);
         lineGeometryMap.clear();
         std::vector<PointGeometry> points(pointGeometryMap.size());
-        for (const auto& [_, pointInfo] : pointGeometryMap) points[pointInfo.id] = std::move(pointInfo.geometry);
+        for (auto& [_, pointInfo] : pointGeometryMap) points[pointInfo.id] = std::move(pointInfo.geometry);
         pointGeometryMap.clear();
         std::vector<Material> materials(materialMap.size());
-        for (const auto& [_, matInfo] : materialMap) materials[matInfo.id] = std::move(matInfo.material);
+        for (auto& [_, matInfo] : materialMap) materials[matInfo.id] = std::move(matInfo.material);
         materialMap.clear();
 
-        // clean up triangulation data to save memory
-        for (TDF_ChildIterator it(shapeTool->Label()); it.More(); it.Next()) {
-            TDF_Label childLabel = it.Value();
-            TopoDS_Shape shape;
-            if (shapeTool->GetShape(childLabel, shape) && shapeTool->IsFree(childLabel)) {
-                BRepTools::Clean(shape, Standard_True);
-            }
+        std::vector<MaterialBatch> materialBatches;
+        if (options.mergeByMaterial) {
+            materialBatches = buildMaterialBatches(tris, meshes, materials.size());
         }
 
         return TriangulatedModel(
@@ -134,10 +284,68 @@ public:
             std::move(lines),
             std::move(points),
             std::move(materials),
-            std::move(meshes)
+            std::move(meshes),
+            std::move(lodTris),
+            coarseLodCount + 1,
+            std::move(materialBatches)
         );
     }
 
+    // remeshes the given shapes, see ModelTriangulationImpl::refineTriangulation
+    bool refine(const std::vector<TopoDS_Shape>& shapes, const std::function<void(size_t, TriGeometry&&)>& onGeometry) {
+        progress->setPhase(TaskPhase::Triangulating, static_cast<uint32_t>(shapes.size()));
+        Message_ProgressScope progressScope(progress->Start(), "Refinement", static_cast<Standard_Real>(std::max<size_t>(1, shapes.size())));
+        std::vector<Message_ProgressRange> shapeProgressRanges; // ranges are created upfront, scopes are not thread-safe
+        shapeProgressRanges.reserve(shapes.size());
+        for (size_t i = 0; i < shapes.size(); ++i) {
+            shapeProgressRanges.push_back(progressScope.Next());
+        }
+
+        std::vector<bool> refinedShapes(shapes.size(), false);
+        auto refineShape = [&](size_t index, bool meshInParallel) {
+            if (progress->isCancelled()) {
+                return;
+            }
+            ShapeTriangulation triangulation = buildShapeTriangulation(shapes[index], shapeProgressRanges[index], meshInParallel);
+            if (!triangulation.completed) {
+                return;
+            }
+            onGeometry(index, std::move(triangulation.triData));
+            progress->addItems(1);
+        };
+
+#ifdef __EMSCRIPTEN_PTHREADS__
+        if (options.parallel && shapes.size() > 1) {
+            const std::vector<bool> exclusiveShapes = findExclusiveShapes(shapes);
+            std::vector<size_t> jobShapeIndices;
+            for (size_t i = 0; i < shapes.size(); ++i) {
+                if (exclusiveShapes[i]) {
+                    jobShapeIndices.push_back(i);
+                    refinedShapes[i] = true;
+                }
+            }
+            TaskScheduler::instance().parallelFor(jobShapeIndices.size(), [&](size_t job) {
+                refineShape(jobShapeIndices[job], Standard_False);
+            });
+        }
+#endif
+        for (size_t i = 0; i < shapes.size(); ++i) {
+            if (!refinedShapes[i]) {
+                refineShape(i, Standard_True);
+            }
+        }
+
+        for (const TopoDS_Shape& shape : shapes) {
+            BRepTools::Clean(shape, Standard_True);
+        }
+        return !progress->isCancelled();
+    }
+
+    // shape of each tri geometry of the last computed model, by geometry index
+    std::vector<TopoDS_Shape>& getTriGeometryShapes() {
+        return triGeometryShapes;
+    }
+
 private:
     TDF_Label resolveReferredShapeLabel(const TDF_Label& label) const {
         TDF_Label resolvedLabel = label;
@@ -172,113 +380,661 @@ private:
         return std::string();
     }
 
-    // shape must be TopoDS_Shell or TopoDS_Solid
-    ProcessedShapeInfo triangulateShape(const TopoDS_Shape& shape) {
-        // check if already processed
-        if (processedShapeMap.find(shape.TShape().get()) != processedShapeMap.end()) {
-            return processedShapeMap[shape.TShape().get()];
+    // solids and shells to be triangulated, in the order resolveShapeTree reaches them
+    static std::vector<TopoDS_Shape> collectUniqueShapes(const std::vector<TopoDS_Shape>& rootShapes) {
+        std::vector<TopoDS_Shape> uniqueShapes;
+        std::unordered_set<TopoDS_TShape*> visitedShapes;
+        for (const TopoDS_Shape& rootShape : rootShapes) {
+            std::vector<TopoDS_Shape> stack = { rootShape };
+            while (!stack.empty()) {
+                TopoDS_Shape shape = stack.back();
+                stack.pop_back();
+
+                if (shape.ShapeType() == TopAbs_COMPOUND || shape.ShapeType() == TopAbs_COMPSOLID) {
+                    for (TopoDS_Iterator it(shape); it.More(); it.Next()) {
+                        stack.push_back(it.Value());
+                    }
+                } else if (shape.ShapeType() == TopAbs_SOLID || shape.ShapeType() == TopAbs_SHELL) {
+                    if (visitedShapes.insert(shape.TShape().get()).second) {
+                        uniqueShapes.push_back(shape);
+                    }
+                }
+            }
         }
+        return uniqueShapes;
+    }
 
-        Standard_Integer triGeometryIndex = -1;
-        Standard_Integer lineGeometryIndex = -1;
-        Standard_Integer pointGeometryIndex = -1;
+    // whether each shape owns all of its faces and edges. BRepMesh writes the mesh into the shared TShape,
+    // so shapes sharing them with another shape must not be meshed concurrently.
+    static std::vector<bool> findExclusiveShapes(const std::vector<TopoDS_Shape>& shapes) {
+        std::vector<bool> exclusiveShapes(shapes.size(), true);
+        std::unordered_map<TopoDS_TShape*, size_t> subShapeOwners;
+        for (size_t i = 0; i < shapes.size(); ++i) {
+            for (TopAbs_ShapeEnum subShapeType : { TopAbs_FACE, TopAbs_EDGE }) {
+                for (TopExp_Explorer explorer(shapes[i], subShapeType); explorer.More(); explorer.Next()) {
+                    const auto [ownerIt, inserted] = subShapeOwners.emplace(explorer.Current().TShape().get(), i);
+                    if (!inserted && ownerIt->second != i) {
+                        exclusiveShapes[i] = false;
+                        exclusiveShapes[ownerIt->second] = false;
+                    }
+                }
+            }
+        }
+        return exclusiveShapes;
+    }
 
-        gp_Trsf parentTransform = shape.Location().Transformation(); // parent global transform
+#ifdef __EMSCRIPTEN_PTHREADS__
+    // meshes the unique shapes concurrently on the task scheduler, except the non-exclusive ones
+    // which are left to the serial traversal.
+    void prebuildShapeTriangulations(const std::vector<TopoDS_Shape>& uniqueShapes, Message_ProgressScope& progressScope) {
+        const std::vector<bool> exclusiveShapes = findExclusiveShapes(uniqueShapes);
 
-        // from StdPrs_ToolTriangulatedShape::GetDeflection
-        constexpr Standard_Real MAXIMAL_CHORDAL_DEVIATION = 0.0001;
-        constexpr Standard_Real DEVIATION_COEFFICIENT = 0.001;
-        Bnd_Box boundBox;
-        BRepBndLib::Add(shape, boundBox, Standard_False);
-        const Standard_Real deflection = Prs3d::GetDeflection(boundBox, DEVIATION_COEFFICIENT, MAXIMAL_CHORDAL_DEVIATION);
-        
-        constexpr Standard_Real ANGLE_DEFLECTION = 0.2;
-        BRepMesh_IncrementalMesh mesh(
-            shape, // The shape to mesh
-            deflection, // Linear deflection
-            Standard_True,  // Relative
-            ANGLE_DEFLECTION, // Angular deflection
-            Standard_True   // In parallel
-        );
+        std::vector<size_t> jobShapeIndices;
+        std::vector<Message_ProgressRange> jobProgressRanges; // ranges are created upfront, scopes are not thread-safe
+        jobProgressRanges.reserve(uniqueShapes.size());
+        for (size_t i = 0; i < uniqueShapes.size(); ++i) {
+            if (exclusiveShapes[i]) {
+                jobShapeIndices.push_back(i);
+                jobProgressRanges.push_back(progressScope.Next());
+            }
+        }
 
-        TriGeometry triData;
-        LineGeometry lineData;
-        PointGeometry pointData;
+        std::vector<ShapeTriangulation> jobResults(jobShapeIndices.size());
+        TaskScheduler::instance().parallelFor(jobShapeIndices.size(), [&](size_t job) {
+            if (progress->isCancelled()) {
+                jobResults[job].completed = false;
+                return;
+            }
+            jobResults[job] = buildShapeTriangulation(uniqueShapes[jobShapeIndices[job]], jobProgressRanges[job], Standard_False);
+            progress->addItems(1);
+        });
 
-        TopExp_Explorer faceExplorer(shape, TopAbs_FACE);
-        for (; faceExplorer.More(); faceExplorer.Next()) {
-            const TopoDS_Face& face = TopoDS::Face(faceExplorer.Current());
-            
-            TopLoc_Location location;
-            Handle(Poly_Triangulation) polyTri = BRep_Tool::Triangulation(face, location);
+        for (size_t job = 0; job < jobShapeIndices.size(); ++job) {
+            if (jobResults[job].completed) {
+                prebuiltShapeMap.emplace(uniqueShapes[jobShapeIndices[job]].TShape().get(), std::move(jobResults[job]));
+            }
+        }
+    }
+#endif
 
-            if (!polyTri.IsNull()) {
-                gp_Trsf childTransform = location.Transformation(); // child global transform
-                gp_Trsf relativeTransform = parentTransform.Inverted().Multiplied(childTransform); // relative transform from parent to child
-                TopAbs_Orientation faceOrientation = face.Orientation();
-                Standard_Size indexOffset = static_cast<Standard_Size>(triData.positions.size() / 3);
-
-                // triData.subMeshIndices.push_back(static_cast<uint32_t>(indexOffset)); // vertex start
-                triData.subMeshIndices.push_back(static_cast<uint32_t>(polyTri->NbNodes())); // vertex count
-                // triData.subMeshIndices.push_back(static_cast<uint32_t>(triData.indices.size())); // index start
-                // triData.subMeshIndices.push_back(static_cast<uint32_t>(polyTri->NbTriangles() * 3)); // index count
-
-                for (Standard_Integer i = 1; i <= polyTri->NbNodes(); ++i) {
-                    gp_Pnt pnt = polyTri->Node(i).Transformed(relativeTransform);
-                    triData.positions.push_back(static_cast<float>(pnt.X()));
-                    triData.positions.push_back(static_cast<float>(pnt.Y()));
-                    triData.positions.push_back(static_cast<float>(pnt.Z()));
+    // appends the face mesh to triData, in the space of the parent shape
+    static void appendFaceTriangulation(
+        const TopoDS_Face& face,
+        const Handle(Poly_Triangulation)& polyTri,
+        const TopLoc_Location& location,
+        const gp_Trsf& parentTransform,
+        TriGeometry& triData
+    ) {
+        gp_Trsf childTransform = location.Transformation(); // child global transform
+        gp_Trsf relativeTransform = parentTransform.Inverted().Multiplied(childTransform); // relative transform from parent to child
+        TopAbs_Orientation faceOrientation = face.Orientation();
+        Standard_Size indexOffset = static_cast<Standard_Size>(triData.getVertexCount());
+        const Standard_Integer nodeCount = polyTri->NbNodes();
+
+        // triData.subMeshIndices.push_back(static_cast<uint32_t>(indexOffset)); // vertex start
+        triData.subMeshIndices.push_back(static_cast<uint32_t>(nodeCount)); // vertex count
+        // triData.subMeshIndices.push_back(static_cast<uint32_t>(triData.indices.size())); // index start
+        triData.subMeshIndexCounts.push_back(static_cast<uint32_t>(polyTri->NbTriangles() * 3)); // index count
+
+        // attributes are written in place, at the face's first vertex of each attribute stream
+        float* positionData;
+        float* normalData;
+        float* uvData;
+        size_t positionStride, normalStride, uvStride;
+        if (triData.layout == VertexLayout::Interleaved) {
+            triData.vertices.resize((indexOffset + nodeCount) * TriGeometry::INTERLEAVED_STRIDE);
+            float* vertexData = triData.vertices.data() + indexOffset * TriGeometry::INTERLEAVED_STRIDE;
+            positionData = vertexData + TriGeometry::INTERLEAVED_POSITION_OFFSET;
+            normalData = vertexData + TriGeometry::INTERLEAVED_NORMAL_OFFSET;
+            uvData = vertexData + TriGeometry::INTERLEAVED_UV_OFFSET;
+            positionStride = normalStride = uvStride = TriGeometry::INTERLEAVED_STRIDE;
+        } else {
+            triData.positions.resize((indexOffset + nodeCount) * 3);
+            triData.normals.resize((indexOffset + nodeCount) * 3);
+            triData.uvs.resize((indexOffset + nodeCount) * 2);
+            positionData = triData.positions.data() + indexOffset * 3;
+            normalData = triData.normals.data() + indexOffset * 3;
+            uvData = triData.uvs.data() + indexOffset * 2;
+            positionStride = normalStride = 3;
+            uvStride = 2;
+        }
+
+        for (Standard_Integer i = 1; i <= nodeCount; ++i) {
+            gp_Pnt pnt = polyTri->Node(i).Transformed(relativeTransform);
+            float* position = positionData + (i - 1) * positionStride;
+            position[0] = static_cast<float>(pnt.X());
+            position[1] = static_cast<float>(pnt.Y());
+            position[2] = static_cast<float>(pnt.Z());
+        }
+
+        BRepLib_ToolTriangulatedShape::ComputeNormals(face, polyTri);
+        Standard_Boolean fixNormals = (faceOrientation == TopAbs_REVERSED) ^ (relativeTransform.VectorialPart().Determinant() < 0);
+        for (Standard_Integer i = 1; i <= nodeCount; ++i) {
+            gp_Dir normal = fixNormals ? polyTri->Normal(i).Reversed().Transformed(relativeTransform) : polyTri->Normal(i).Transformed(relativeTransform);
+            float* normalValue = normalData + (i - 1) * normalStride;
+            normalValue[0] = static_cast<float>(normal.X());
+            normalValue[1] = static_cast<float>(normal.Y());
+            normalValue[2] = static_cast<float>(normal.Z());
+        }
+
+        Standard_Real umin, umax, vmin, vmax;
+        BRepTools::UVBounds(face, umin, umax, vmin, vmax);
+        for (Standard_Integer i = 1; i <= nodeCount; ++i) {
+            gp_Pnt2d uv = polyTri->UVNode(i);
+            float* uvValue = uvData + (i - 1) * uvStride;
+            uvValue[0] = static_cast<float>((uv.X() - umin) / (umax - umin));
+            uvValue[1] = static_cast<float>((uv.Y() - vmin) / (vmax - vmin));
+        }
+
+        if (faceOrientation == TopAbs_REVERSED) {
+            // reverse triangle winding order
+            for (Standard_Integer i = 1; i <= polyTri->NbTriangles(); ++i) {
+                Standard_Integer n1, n2, n3;
+                polyTri->Triangle(i).Get(n1, n2, n3);
+                // convert to zero-based index
+                triData.indices.push_back(static_cast<uint32_t>(n1 - 1 + indexOffset));
+                triData.indices.push_back(static_cast<uint32_t>(n2 - 1 + indexOffset));
+                triData.indices.push_back(static_cast<uint32_t>(n3 - 1 + indexOffset));
+            }
+        } else {
+            for (Standard_Integer i = 1; i <= polyTri->NbTriangles(); ++i) {
+                Standard_Integer n1, n2, n3;
+                polyTri->Triangle(i).Get(n1, n2, n3);
+                // convert to zero-based index
+                triData.indices.push_back(static_cast<uint32_t>(n1 - 1 + indexOffset));
+                triData.indices.push_back(static_cast<uint32_t>(n3 - 1 + indexOffset));
+                triData.indices.push_back(static_cast<uint32_t>(n2 - 1 + indexOffset));
+            }
+        }
+    }
+
+    // faces are appended in float layouts, the quantized one is derived once the bounding box is known
+    VertexLayout getBuildLayout() const {
+        return options.vertexLayout == VertexLayout::Interleaved ? VertexLayout::Interleaved : VertexLayout::Separate;
+    }
+
+    // octahedral encoding of a unit vector to two snorm16 values
+    static std::array<int16_t, 2> encodeOctNormal(float x, float y, float z) {
+        const float length = std::abs(x) + std::abs(y) + std::abs(z);
+        float u = length > 0.0f ? x / length : 0.0f;
+        float v = length > 0.0f ? y / length : 0.0f;
+        if (z < 0.0f) {
+            const float foldedU = (1.0f - std::abs(v)) * (u >= 0.0f ? 1.0f : -1.0f);
+            const float foldedV = (1.0f - std::abs(u)) * (v >= 0.0f ? 1.0f : -1.0f);
+            u = foldedU;
+            v = foldedV;
+        }
+        return {
+            static_cast<int16_t>(std::lround(std::clamp(u, -1.0f, 1.0f) * 32767.0f)),
+            static_cast<int16_t>(std::lround(std::clamp(v, -1.0f, 1.0f) * 32767.0f))
+        };
+    }
+
+    static uint16_t encodeUnorm16(float value) {
+        return static_cast<uint16_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * 65535.0f));
+    }
+
+    // converts a separate layout geometry to the quantized layout
+    static void quantizeVertices(TriGeometry& triData) {
+        const size_t vertexCount = triData.getVertexCount();
+        std::array<float, 3> boundMin = { 0.0f, 0.0f, 0.0f };
+        std::array<float, 3> boundMax = { 0.0f, 0.0f, 0.0f };
+        if (vertexCount > 0) {
+            std::copy_n(triData.positions.begin(), 3, boundMin.begin());
+            std::copy_n(triData.positions.begin(), 3, boundMax.begin());
+        }
+        for (size_t i = 0; i < vertexCount; ++i) {
+            for (size_t axis = 0; axis < 3; ++axis) {
+                boundMin[axis] = std::min(boundMin[axis], triData.positions[i * 3 + axis]);
+                boundMax[axis] = std::max(boundMax[axis], triData.positions[i * 3 + axis]);
+            }
+        }
+        std::array<float, 3> extent;
+        for (size_t axis = 0; axis < 3; ++axis) {
+            extent[axis] = boundMax[axis] > boundMin[axis] ? boundMax[axis] - boundMin[axis] : 1.0f; // flat axis
+        }
+
+        triData.quantizedVertices.resize(vertexCount * TriGeometry::QUANTIZED_STRIDE);
+        for (size_t i = 0; i < vertexCount; ++i) {
+            uint16_t* vertex = triData.quantizedVertices.data() + i * TriGeometry::QUANTIZED_STRIDE;
+            for (size_t axis = 0; axis < 3; ++axis) {
+                vertex[TriGeometry::QUANTIZED_POSITION_OFFSET + axis] = encodeUnorm16((triData.positions[i * 3 + axis] - boundMin[axis]) / extent[axis]);
+            }
+            vertex[TriGeometry::QUANTIZED_POSITION_OFFSET + 3] = 0;
+            const std::array<int16_t, 2> normal = encodeOctNormal(triData.normals[i * 3], triData.normals[i * 3 + 1], triData.normals[i * 3 + 2]);
+            vertex[TriGeometry::QUANTIZED_NORMAL_OFFSET] = static_cast<uint16_t>(normal[0]);
+            vertex[TriGeometry::QUANTIZED_NORMAL_OFFSET + 1] = static_cast<uint16_t>(normal[1]);
+            vertex[TriGeometry::QUANTIZED_UV_OFFSET] = encodeUnorm16(triData.uvs[i * 2]);
+            vertex[TriGeometry::QUANTIZED_UV_OFFSET + 1] = encodeUnorm16(triData.uvs[i * 2 + 1]);
+        }
+
+        triData.dequantizationMatrix = {
+            extent[0], 0.0f, 0.0f, 0.0f,
+            0.0f, extent[1], 0.0f, 0.0f,
+            0.0f, 0.0f, extent[2], 0.0f,
+            boundMin[0], boundMin[1], boundMin[2], 1.0f
+        };
+        triData.layout = VertexLayout::Quantized;
+        triData.positions = std::vector<float>();
+        triData.normals = std::vector<float>();
+        triData.uvs = std::vector<float>();
+    }
+
+    // converts a geometry built with getBuildLayout to its output form
+    void finishTriGeometry(TriGeometry& triData) const {
+        if (options.weldVertices) {
+            weldVertices(triData, static_cast<float>(std::cos(options.weldAngle)));
+        }
+        if (options.optimizeVertexCache) {
+            optimizeVertexOrder(triData);
+        }
+        if (options.buildMeshlets) {
+            // before quantization, positions are still floats
+            const bool interleaved = triData.layout == VertexLayout::Interleaved;
+            MeshOptimizer::buildMeshlets(
+                triData.indices.data(), triData.indices.size(),
+                interleaved ? triData.vertices.data() + TriGeometry::INTERLEAVED_POSITION_OFFSET : triData.positions.data(),
+                interleaved ? TriGeometry::INTERLEAVED_STRIDE : 3,
+                triData.getVertexCount(),
+                triData.meshlets, triData.meshletVertices, triData.meshletTriangles, triData.meshletBounds);
+        }
+        {
+            const bool interleaved = triData.layout == VertexLayout::Interleaved;
+            computeBounds(
+                interleaved ? triData.vertices.data() + TriGeometry::INTERLEAVED_POSITION_OFFSET : triData.positions.data(),
+                interleaved ? TriGeometry::INTERLEAVED_STRIDE : 3,
+                triData.getVertexCount(),
+                triData.bounds, triData.boundingSphere);
+        }
+        if (options.vertexLayout == VertexLayout::Quantized) {
+            quantizeVertices(triData);
+        }
+        if (options.compactIndices) {
+            compactIndices(triData);
+        }
+    }
+
+    // optimizes each face on its own, so that the vertex and index ranges of the faces stay valid.
+    // after welding, faces also use vertices of earlier faces; those keep their place.
+    static void optimizeVertexOrder(TriGeometry& triData) {
+        const size_t vertexCount = triData.getVertexCount();
+        constexpr uint32_t NOT_IN_FACE = std::numeric_limits<uint32_t>::max();
+        std::vector<uint32_t> localVertices(vertexCount, NOT_IN_FACE);
+        std::vector<uint32_t> faceVertices;
+        std::vector<uint32_t> faceIndices;
+        std::vector<uint32_t> remap(vertexCount);
+
+        size_t indexBegin = 0;
+        uint32_t vertexBegin = 0;
+        for (size_t face = 0; face < triData.subMeshIndices.size(); ++face) {
+            const uint32_t faceVertexCount = triData.subMeshIndices[face];
+            const size_t faceIndexCount = triData.subMeshIndexCounts[face];
+            uint32_t* indices = triData.indices.data() + indexBegin;
+
+            // dense local numbering of the vertices used by the face
+            faceIndices.resize(faceIndexCount);
+            for (size_t i = 0; i < faceIndexCount; ++i) {
+                uint32_t& localVertex = localVertices[indices[i]];
+                if (localVertex == NOT_IN_FACE) {
+                    localVertex = static_cast<uint32_t>(faceVertices.size());
+                    faceVertices.push_back(indices[i]);
                 }
+                faceIndices[i] = localVertex;
+            }
+            MeshOptimizer::optimizeVertexCache(faceIndices.data(), faceIndexCount, 0, faceVertices.size());
+            for (size_t i = 0; i < faceIndexCount; ++i) {
+                indices[i] = faceVertices[faceIndices[i]];
+            }
+            for (uint32_t vertex : faceVertices) {
+                localVertices[vertex] = NOT_IN_FACE;
+            }
+            faceVertices.clear();
+
+            MeshOptimizer::buildVertexFetchRemap(indices, faceIndexCount, vertexBegin, faceVertexCount, remap.data() + vertexBegin);
+            for (uint32_t v = vertexBegin; v < vertexBegin + faceVertexCount; ++v) {
+                remap[v] += vertexBegin;
+            }
+            indexBegin += faceIndexCount;
+            vertexBegin += faceVertexCount;
+        }
+
+        for (uint32_t& index : triData.indices) {
+            index = remap[index];
+        }
+        triData.remapVertices(remap, vertexCount);
+    }
+
+    // merges vertices with a coincident position and a normal within the tolerance into the first of them.
+    // each face keeps the vertices it introduced, so subMeshIndices still partitions the vertices by face,
+    // while subMeshIndexCounts gives the triangles of the faces. the uv of the first face is kept.
+    // only vertices of different faces are merged, and never two of the same face into one, so that the
+    // seam vertices of periodic surfaces keep their own uvs.
+    static void weldVertices(TriGeometry& triData, float minNormalDot) {
+        const size_t vertexCount = triData.getVertexCount();
+        if (vertexCount == 0) {
+            return;
+        }
+
+        const bool interleaved = triData.layout == VertexLayout::Interleaved;
+        const float* positions = interleaved ? triData.vertices.data() + TriGeometry::INTERLEAVED_POSITION_OFFSET : triData.positions.data();
+        const float* normals = interleaved ? triData.vertices.data() + TriGeometry::INTERLEAVED_NORMAL_OFFSET : triData.normals.data();
+        const size_t stride = interleaved ? TriGeometry::INTERLEAVED_STRIDE : 3;
+
+        // tolerance relative to the geometry size, vertices of adjacent faces differ by rounding only
+        std::array<float, 3> boundMin = { positions[0], positions[1], positions[2] };
+        std::array<float, 3> boundMax = boundMin;
+        for (size_t i = 1; i < vertexCount; ++i) {
+            for (size_t axis = 0; axis < 3; ++axis) {
+                boundMin[axis] = std::min(boundMin[axis], positions[i * stride + axis]);
+                boundMax[axis] = std::max(boundMax[axis], positions[i * stride + axis]);
+            }
+        }
+        const float diagonal = std::sqrt(
+            (boundMax[0] - boundMin[0]) * (boundMax[0] - boundMin[0]) +
+            (boundMax[1] - boundMin[1]) * (boundMax[1] - boundMin[1]) +
+            (boundMax[2] - boundMin[2]) * (boundMax[2] - boundMin[2]));
+        const float tolerance = std::max(diagonal * 1e-6f, std::numeric_limits<float>::min());
+
+        // kept vertices by grid cell of the tolerance size, chained through nextInCell.
+        // twins within the tolerance may straddle a cell border, so the neighbouring cells are probed too.
+        using Cell = std::array<int64_t, 3>;
+        auto getCell = [&](size_t vertex) {
+            Cell cell;
+            for (size_t axis = 0; axis < 3; ++axis) {
+                cell[axis] = static_cast<int64_t>(std::floor((positions[vertex * stride + axis] - boundMin[axis]) / tolerance));
+            }
+            return cell;
+        };
+        auto getCellKey = [](const Cell& cell) {
+            uint64_t key = 0;
+            for (int64_t coordinate : cell) {
+                key = key * 0x9e3779b97f4a7c15ull + static_cast<uint64_t>(coordinate);
+            }
+            return key;
+        };
+        constexpr uint32_t NO_VERTEX = std::numeric_limits<uint32_t>::max();
+        std::unordered_map<uint64_t, uint32_t> cellFirstVertex;
+        std::vector<uint32_t> nextInCell(vertexCount, NO_VERTEX);
 
-                BRepLib_ToolTriangulatedShape::ComputeNormals(face, polyTri);
-                Standard_Boolean fixNormals = (faceOrientation == TopAbs_REVERSED) ^ (relativeTransform.VectorialPart().Determinant() < 0);
-                if (fixNormals) {
-                    for (Standard_Integer i = 1; i <= polyTri->NbNodes(); ++i) {
-                        gp_Dir normal = polyTri->Normal(i).Reversed().Transformed(relativeTransform);
-                        triData.normals.push_back(static_cast<float>(normal.X()));
-                        triData.normals.push_back(static_cast<float>(normal.Y()));
-                        triData.normals.push_back(static_cast<float>(normal.Z()));
+        std::vector<uint32_t> remap(vertexCount);
+        std::vector<size_t> weldedVertexFaces; // last face using each welded vertex
+        weldedVertexFaces.reserve(vertexCount);
+        uint32_t weldedVertexCount = 0;
+        size_t vertexBegin = 0;
+        for (size_t face = 0; face < triData.subMeshIndices.size(); ++face) {
+            uint32_t& faceVertexCount = triData.subMeshIndices[face];
+            uint32_t introducedVertexCount = 0;
+            for (size_t v = vertexBegin; v < vertexBegin + faceVertexCount; ++v) {
+                const float* position = positions + v * stride;
+                const float* normal = normals + v * stride;
+                const Cell cell = getCell(v);
+
+                uint32_t match = NO_VERTEX;
+                for (int64_t dx = -1; dx <= 1 && match == NO_VERTEX; ++dx) {
+                    for (int64_t dy = -1; dy <= 1 && match == NO_VERTEX; ++dy) {
+                        for (int64_t dz = -1; dz <= 1 && match == NO_VERTEX; ++dz) {
+                            const auto cellIt = cellFirstVertex.find(getCellKey({ cell[0] + dx, cell[1] + dy, cell[2] + dz }));
+                            if (cellIt == cellFirstVertex.end()) {
+                                continue;
+                            }
+                            for (uint32_t candidate = cellIt->second; candidate != NO_VERTEX; candidate = nextInCell[candidate]) {
+                                if (weldedVertexFaces[remap[candidate]] == face) {
+                                    continue; // of this face, or already taken by another vertex of it
+                                }
+                                const float* candidatePosition = positions + candidate * stride;
+                                const float* candidateNormal = normals + candidate * stride;
+                                const float normalDot = normal[0] * candidateNormal[0] + normal[1] * candidateNormal[1] + normal[2] * candidateNormal[2];
+                                if (std::abs(position[0] - candidatePosition[0]) <= tolerance
+                                    && std::abs(position[1] - candidatePosition[1]) <= tolerance
+                                    && std::abs(position[2] - candidatePosition[2]) <= tolerance
+                                    && normalDot >= minNormalDot) {
+                                    match = candidate;
+                                    break;
+                                }
+                            }
+                        }
                     }
+                }
+
+                if (match != NO_VERTEX) {
+                    remap[v] = remap[match];
+                    weldedVertexFaces[remap[v]] = face;
                 } else {
-                    for (Standard_Integer i = 1; i <= polyTri->NbNodes(); ++i) {
-                        gp_Dir normal = polyTri->Normal(i).Transformed(relativeTransform);
-                        triData.normals.push_back(static_cast<float>(normal.X()));
-                        triData.normals.push_back(static_cast<float>(normal.Y()));
-                        triData.normals.push_back(static_cast<float>(normal.Z()));
+                    remap[v] = weldedVertexCount++;
+                    weldedVertexFaces.push_back(face);
+                    ++introducedVertexCount;
+                    const auto [cellIt, inserted] = cellFirstVertex.emplace(getCellKey(cell), static_cast<uint32_t>(v));
+                    if (!inserted) {
+                        nextInCell[v] = cellIt->second;
+                        cellIt->second = static_cast<uint32_t>(v);
                     }
                 }
+            }
+            vertexBegin += faceVertexCount;
+            faceVertexCount = introducedVertexCount;
+        }
 
-                Standard_Real umin, umax, vmin, vmax;
-                BRepTools::UVBounds(face, umin, umax, vmin, vmax);
-                for (Standard_Integer i = 1; i <= polyTri->NbNodes(); ++i) {
-                    gp_Pnt2d uv = polyTri->UVNode(i);
-                    float u = static_cast<float>((uv.X() - umin) / (umax - umin));
-                    float v = static_cast<float>((uv.Y() - vmin) / (vmax - vmin));
-                    triData.uvs.push_back(u);
-                    triData.uvs.push_back(v);
+        for (uint32_t& index : triData.indices) {
+            index = remap[index];
+        }
+        triData.remapVertices(remap, weldedVertexCount);
+    }
+
+    // switches to 16-bit indices if every vertex is addressable with them. 0xFFFF is left out,
+    // it restarts primitives in WebGL2 and glTF forbids the maximum index value.
+    static void compactIndices(TriGeometry& triData) {
+        if (triData.getVertexCount() >= 65536) {
+            return;
+        }
+        triData.indices16.assign(triData.indices.begin(), triData.indices.end());
+        triData.indices = std::vector<uint32_t>();
+        triData.indexFormat = IndexFormat::Uint16;
+    }
+
+    // parallel and mergeByMaterial are left out, they do not change the shape triangulations
+    static uint64_t hashOptions(const TriangulationOptions& options) {
+        ContentHasher hasher;
+        auto add = [&hasher](auto value) { hasher.update(&value, sizeof(value)); };
+        add(options.linearDeflection);
+        add(options.angularDeflection);
+        add(options.relative);
+        add(options.minSize);
+        add(options.lodCount);
+        add(options.lodDeflectionScale);
+        add(options.vertexLayout);
+        add(options.compactIndices);
+        add(options.optimizeVertexCache);
+        add(options.buildMeshlets);
+        add(options.weldVertices);
+        add(options.weldAngle);
+        return hasher.digest();
+    }
+
+    Standard_Real getShapeDeflection(const TopoDS_Shape& shape) const {
+        if (!options.relative) {
+            return options.linearDeflection;
+        }
+        // from StdPrs_ToolTriangulatedShape::GetDeflection
+        constexpr Standard_Real MAXIMAL_CHORDAL_DEVIATION = 0.0001;
+        Bnd_Box boundBox;
+        BRepBndLib::Add(shape, boundBox, Standard_False);
+        return Prs3d::GetDeflection(boundBox, options.linearDeflection, MAXIMAL_CHORDAL_DEVIATION);
+    }
+
+    // the output is in the space of the shape, so the key leaves out its location except for what changes
+    // the meshing: the relative deflection, from the bounding box in the parent space, and the scale.
+    std::string getShapeCacheKey(const TopoDS_Shape& shape) const {
+        ContentHasher contentHasher;
+        HashingStreamBuf hashingBuffer(contentHasher);
+        std::ostream stream(&hashingBuffer);
+        BinTools::Write(shape.Located(TopLoc_Location()), stream, Standard_False, Standard_False, BinTools_FormatVersion_CURRENT);
+        stream.flush();
+
+        ContentHasher parameterHasher(optionsHash);
+        const Standard_Real deflection = getShapeDeflection(shape);
+        const Standard_Real scale = shape.Location().Transformation().ScaleFactor();
+        parameterHasher.update(&deflection, sizeof(deflection));
+        parameterHasher.update(&scale, sizeof(scale));
+
+        return ContentHasher::toHex(contentHasher.digest())
+            + "-" + ContentHasher::toHex(parameterHasher.digest());
+    }
+
+    // matches a cache entry with the edges and vertices of the shape, in the traversal order of meshShapeTriangulation.
+    // returns std::nullopt if the entry does not fit the shape.
+    std::optional<ShapeTriangulation> restoreShapeTriangulation(const TopoDS_Shape& shape, ModelSerialization::ShapeEntry&& entry) const {
+        if (entry.levels.size() != static_cast<size_t>(std::max(1, options.lodCount))) {
+            return std::nullopt;
+        }
+
+        ShapeTriangulation result;
+        std::unordered_set<TopoDS_TShape*> shapeEdgeSet;
+        for (TopExp_Explorer faceExplorer(shape, TopAbs_FACE); faceExplorer.More(); faceExplorer.Next()) {
+            for (TopExp_Explorer edgeExplorer(faceExplorer.Current(), TopAbs_EDGE); edgeExplorer.More(); edgeExplorer.Next()) {
+                TopoDS_TShape* edge = edgeExplorer.Current().TShape().get();
+                if (!shapeEdgeSet.insert(edge).second) {
+                    continue;
+                }
+                if (result.edgeLines.size() == entry.edgeLines.size()) {
+                    return std::nullopt;
                 }
+                result.edgeLines.push_back({ edge, std::move(entry.edgeLines[result.edgeLines.size()]) });
+            }
+        }
 
-                if (faceOrientation == TopAbs_REVERSED) {
-                    // reverse triangle winding order
-                    for (Standard_Integer i = 1; i <= polyTri->NbTriangles(); ++i) {
-                        Standard_Integer n1, n2, n3;
-                        polyTri->Triangle(i).Get(n1, n2, n3);
-                        // convert to zero-based index
-                        triData.indices.push_back(static_cast<uint32_t>(n1 - 1 + indexOffset));
-                        triData.indices.push_back(static_cast<uint32_t>(n2 - 1 + indexOffset));
-                        triData.indices.push_back(static_cast<uint32_t>(n3 - 1 + indexOffset));
-                    }
-                } else {
-                    for (Standard_Integer i = 1; i <= polyTri->NbTriangles(); ++i) {
-                        Standard_Integer n1, n2, n3;
-                        polyTri->Triangle(i).Get(n1, n2, n3);
-                        // convert to zero-based index
-                        triData.indices.push_back(static_cast<uint32_t>(n1 - 1 + indexOffset));
-                        triData.indices.push_back(static_cast<uint32_t>(n3 - 1 + indexOffset));
-                        triData.indices.push_back(static_cast<uint32_t>(n2 - 1 + indexOffset));
+        std::unordered_set<TopoDS_TShape*> shapePointSet;
+        for (TopExp_Explorer vertexExplorer(shape, TopAbs_VERTEX); vertexExplorer.More(); vertexExplorer.Next()) {
+            TopoDS_TShape* vertex = vertexExplorer.Current().TShape().get();
+            if (!shapePointSet.insert(vertex).second) {
+                continue;
+            }
+            if (result.vertexPoints.size() == entry.vertexPoints.size()) {
+                return std::nullopt;
+            }
+            result.vertexPoints.push_back({ vertex, entry.vertexPoints[result.vertexPoints.size()] });
+        }
+
+        if (result.edgeLines.size() != entry.edgeLines.size() || result.vertexPoints.size() != entry.vertexPoints.size()) {
+            return std::nullopt;
+        }
+        result.triData = std::move(entry.levels.front());
+        result.lodTriData.assign(std::make_move_iterator(entry.levels.begin() + 1), std::make_move_iterator(entry.levels.end()));
+        return result;
+    }
+
+    static ByteBuffer writeShapeEntry(ShapeTriangulation& triangulation) {
+        // the geometries are moved into the entry for writing and back afterwards
+        ModelSerialization::ShapeEntry entry;
+        entry.levels.reserve(triangulation.lodTriData.size() + 1);
+        entry.levels.push_back(std::move(triangulation.triData));
+        std::move(triangulation.lodTriData.begin(), triangulation.lodTriData.end(), std::back_inserter(entry.levels));
+        entry.edgeLines.reserve(triangulation.edgeLines.size());
+        for (EdgeLines& edgeLines : triangulation.edgeLines) {
+            entry.edgeLines.push_back(std::move(edgeLines.positions));
+        }
+        entry.vertexPoints.reserve(triangulation.vertexPoints.size());
+        for (const VertexPoint& vertexPoint : triangulation.vertexPoints) {
+            entry.vertexPoints.push_back(vertexPoint.position);
+        }
+
+        ByteBuffer data = ModelSerialization::writeShapeEntry(entry);
+
+        triangulation.triData = std::move(entry.levels.front());
+        std::move(entry.levels.begin() + 1, entry.levels.end(), triangulation.lodTriData.begin());
+        for (size_t i = 0; i < entry.edgeLines.size(); ++i) {
+            triangulation.edgeLines[i].positions = std::move(entry.edgeLines[i]);
+        }
+        return data;
+    }
+
+    // shape must be TopoDS_Shell or TopoDS_Solid.
+    // does not touch the context state, so that unique shapes can be built concurrently.
+    // with a cache, a stored triangulation of the same shape content replaces the meshing.
+    ShapeTriangulation buildShapeTriangulation(const TopoDS_Shape& shape, const Message_ProgressRange& progressRange, bool meshInParallel) const {
+        if (cache == nullptr) {
+            return meshShapeTriangulation(shape, progressRange, meshInParallel);
+        }
+
+        const std::string key = getShapeCacheKey(shape);
+        if (std::optional<std::vector<uint8_t>> data = cache->load(key, waitForCache)) {
+            std::optional<ModelSerialization::ShapeEntry> entry = ModelSerialization::readShapeEntry(data->data(), data->size());
+            if (entry.has_value()) {
+                std::optional<ShapeTriangulation> result = restoreShapeTriangulation(shape, std::move(*entry));
+                if (result.has_value()) {
+                    return std::move(*result);
+                }
+            }
+        }
+
+        ShapeTriangulation result = meshShapeTriangulation(shape, progressRange, meshInParallel);
+        if (result.completed) {
+            cache->store(key, writeShapeEntry(result));
+        }
+        return result;
+    }
+
+    ShapeTriangulation meshShapeTriangulation(const TopoDS_Shape& shape, const Message_ProgressRange& progressRange, bool meshInParallel) const {
+        ShapeTriangulation result;
+        // for remove edge and point duplication within this shape
+        std::unordered_set<TopoDS_TShape*> shapeEdgeSet;
+        std::unordered_set<TopoDS_TShape*> shapePointSet;
+
+        gp_Trsf parentTransform = shape.Location().Transformation(); // parent global transform
+
+        const Standard_Real deflection = getShapeDeflection(shape);
+
+        // coarse levels are meshed first, as BRepMesh only replaces an existing mesh by a finer one
+        const int lodCount = std::max(1, options.lodCount);
+        result.lodTriData.resize(static_cast<size_t>(lodCount - 1));
+        Message_ProgressScope lodScope(progressRange, "Levels of detail", lodCount);
+        for (int level = lodCount - 1; level >= 0; --level) {
+            const Standard_Real scale = std::pow(options.lodDeflectionScale, level);
+
+            IMeshTools_Parameters meshParameters;
+            meshParameters.Deflection = deflection * scale; // Linear deflection
+            meshParameters.Relative = options.relative; // Relative
+            // the cap is for coarse levels only, and never below the requested angle so that they stay coarser than level 0
+            meshParameters.Angle = level > 0
+                ? std::min(options.angularDeflection * scale, std::max(options.angularDeflection, MAXIMAL_LOD_ANGLE_DEFLECTION))
+                : options.angularDeflection; // Angular deflection
+            meshParameters.InParallel = meshInParallel && options.parallel; // In parallel
+            if (options.minSize > 0.0) {
+                meshParameters.MinSize = options.minSize * scale; // Minimal element size
+            }
+            BRepMesh_IncrementalMesh mesh(shape, meshParameters, lodScope.Next());
+            if (progress->isCancelled()) {
+                // the mesh is incomplete, leave the shape unprocessed
+                result.completed = false;
+                return result;
+            }
+
+            if (level > 0) {
+                TriGeometry& lodTriData = result.lodTriData[static_cast<size_t>(level - 1)];
+                lodTriData.layout = getBuildLayout();
+                for (TopExp_Explorer faceExplorer(shape, TopAbs_FACE); faceExplorer.More(); faceExplorer.Next()) {
+                    const TopoDS_Face& face = TopoDS::Face(faceExplorer.Current());
+                    TopLoc_Location location;
+                    Handle(Poly_Triangulation) polyTri = BRep_Tool::Triangulation(face, location);
+                    if (!polyTri.IsNull()) {
+                        appendFaceTriangulation(face, polyTri, location, parentTransform, lodTriData);
                     }
                 }
             }
+        }
+
+        TriGeometry& triData = result.triData;
+        triData.layout = getBuildLayout();
+
+        TopExp_Explorer faceExplorer(shape, TopAbs_FACE);
+        for (; faceExplorer.More(); faceExplorer.Next()) {
+            const TopoDS_Face& face = TopoDS::Face(faceExplorer.Current());
+            
+            TopLoc_Location location;
+            Handle(Poly_Triangulation) polyTri = BRep_Tool::Triangulation(face, location);
+
+            if (!polyTri.IsNull()) {
+                appendFaceTriangulation(face, polyTri, location, parentTransform, triData);
+            }
 
             // edge triangulation
             {
@@ -287,10 +1043,11 @@ private:
                     TopoDS_Edge edge = TopoDS::Edge(edgeExplorer.Current());
 
                     // skip if already processed
-                    if (processedEdgeSet.find(edge.TShape().get()) != processedEdgeSet.end()) {
+                    if (!shapeEdgeSet.insert(edge.TShape().get()).second) {
                         continue;
                     }
-                    processedEdgeSet.insert(edge.TShape().get());
+                    // kept even when no lines are produced, so that other shapes skip the edge as well
+                    std::vector<float>& linePositions = result.edgeLines.emplace_back(EdgeLines{ edge.TShape().get(), {} }).positions;
 
                     gp_Trsf childTransform = edge.Location().Transformation();
                     gp_Trsf relativeTransform = parentTransform.Inverted().Multiplied(childTransform); // relative transform from parent to child
@@ -303,21 +1060,18 @@ private:
                         if (!polypolyTri.IsNull()) {
                             if (polypolyTri->NbNodes() < 2) continue; // NOTE: this might be unreachable
 
-                            // lineData.subMeshIndices.push_back(static_cast<uint32_t>(lineData.positions.size() / 3)); // vertex start
-                            lineData.subMeshIndices.push_back(static_cast<uint32_t>((polypolyTri->NbNodes() - 1) * 2)); // vertex count
-
                             const TColStd_Array1OfInteger& nodes = polypolyTri->Nodes();
                             for (Standard_Integer i = nodes.Lower(); i < nodes.Upper(); ++i) {
                                 gp_Pnt pnt1 = polyTri->Node(nodes.Value(i)).Transformed(relativeTransform);
                                 gp_Pnt pnt2 = polyTri->Node(nodes.Value(i + 1)).Transformed(relativeTransform);
                                 
-                                lineData.positions.push_back(static_cast<float>(pnt1.X()));
-                                lineData.positions.push_back(static_cast<float>(pnt1.Y()));
-                                lineData.positions.push_back(static_cast<float>(pnt1.Z()));
+                                linePositions.push_back(static_cast<float>(pnt1.X()));
+                                linePositions.push_back(static_cast<float>(pnt1.Y()));
+                                linePositions.push_back(static_cast<float>(pnt1.Z()));
 
-                                lineData.positions.push_back(static_cast<float>(pnt2.X()));
-                                lineData.positions.push_back(static_cast<float>(pnt2.Y()));
-                                lineData.positions.push_back(static_cast<float>(pnt2.Z()));
+                                linePositions.push_back(static_cast<float>(pnt2.X()));
+                                linePositions.push_back(static_cast<float>(pnt2.Y()));
+                                linePositions.push_back(static_cast<float>(pnt2.Z()));
                             }
                             continue;
                         }
@@ -328,23 +1082,20 @@ private:
 
                         // fallback to curve sampling
                         BRepAdaptor_Curve curve(edge);
-                        GCPnts_TangentialDeflection points(curve, ANGLE_DEFLECTION, deflection);
+                        GCPnts_TangentialDeflection points(curve, options.angularDeflection, deflection);
                         if (points.NbPoints() < 2) continue; // NOTE: this might be unreachable
 
-                        // lineData.subMeshIndices.push_back(static_cast<uint32_t>(lineData.positions.size() / 3)); // vertex start
-                        lineData.subMeshIndices.push_back(static_cast<uint32_t>((points.NbPoints() - 1) * 2)); // vertex count
-
                         for (Standard_Integer i = 1; i < points.NbPoints(); ++i) {
                             gp_Pnt pnt1 = points.Value(i);
                             gp_Pnt pnt2 = points.Value(i + 1);
 
-                            lineData.positions.push_back(static_cast<float>(pnt1.X()));
-                            lineData.positions.push_back(static_cast<float>(pnt1.Y()));
-                            lineData.positions.push_back(static_cast<float>(pnt1.Z()));
+                            linePositions.push_back(static_cast<float>(pnt1.X()));
+                            linePositions.push_back(static_cast<float>(pnt1.Y()));
+                            linePositions.push_back(static_cast<float>(pnt1.Z()));
 
-                            lineData.positions.push_back(static_cast<float>(pnt2.X()));
-                            lineData.positions.push_back(static_cast<float>(pnt2.Y()));
-                            lineData.positions.push_back(static_cast<float>(pnt2.Z()));
+                            linePositions.push_back(static_cast<float>(pnt2.X()));
+                            linePositions.push_back(static_cast<float>(pnt2.Y()));
+                            linePositions.push_back(static_cast<float>(pnt2.Z()));
                         }
                         continue;
                     }
@@ -359,10 +1110,9 @@ private:
                 TopoDS_Vertex vertex = TopoDS::Vertex(vertexExplorer.Current());
 
                 // skip if already processed
-                if (processedPointSet.find(vertex.TShape().get()) != processedPointSet.end()) {
+                if (!shapePointSet.insert(vertex.TShape().get()).second) {
                     continue;
                 }
-                processedPointSet.insert(vertex.TShape().get());
 
                 gp_Trsf childTransform = vertex.Location().Transformation();
                 gp_Trsf relativeTransform = parentTransform.Inverted().Multiplied(childTransform); // relative transform from parent to child
@@ -370,19 +1120,59 @@ private:
                 vertex.Location(TopLoc_Location(relativeTransform));
 
                 gp_Pnt pnt = BRep_Tool::Pnt(vertex);
-                pointData.positions.push_back(static_cast<float>(pnt.X()));
-                pointData.positions.push_back(static_cast<float>(pnt.Y()));
-                pointData.positions.push_back(static_cast<float>(pnt.Z()));
+                result.vertexPoints.push_back({
+                    vertex.TShape().get(),
+                    { static_cast<float>(pnt.X()), static_cast<float>(pnt.Y()), static_cast<float>(pnt.Z()) }
+                });
             }
         }
 
-        if (!triData.positions.empty() && !triData.indices.empty()) {
+        finishTriGeometry(triData);
+        for (TriGeometry& lodTriData : result.lodTriData) {
+            finishTriGeometry(lodTriData);
+        }
+
+        return result;
+    }
+
+    // adds the shape geometries to the output, dropping edges and points which earlier shapes already own
+    ProcessedShapeInfo registerShapeTriangulation(const TopoDS_Shape& shape, ShapeTriangulation&& triangulation) {
+        Standard_Integer triGeometryIndex = -1;
+        Standard_Integer lineGeometryIndex = -1;
+        Standard_Integer pointGeometryIndex = -1;
+
+        TriGeometry& triData = triangulation.triData;
+        LineGeometry lineData;
+        PointGeometry pointData;
+
+        for (const EdgeLines& edgeLines : triangulation.edgeLines) {
+            if (!processedEdgeSet.insert(edgeLines.edge).second || edgeLines.positions.empty()) {
+                continue;
+            }
+            // lineData.subMeshIndices.push_back(static_cast<uint32_t>(lineData.positions.size() / 3)); // vertex start
+            lineData.subMeshIndices.push_back(static_cast<uint32_t>(edgeLines.positions.size() / 3)); // vertex count
+            lineData.positions.insert(lineData.positions.end(), edgeLines.positions.begin(), edgeLines.positions.end());
+        }
+
+        for (const VertexPoint& vertexPoint : triangulation.vertexPoints) {
+            if (!processedPointSet.insert(vertexPoint.vertex).second) {
+                continue;
+            }
+            pointData.positions.insert(pointData.positions.end(), vertexPoint.position.begin(), vertexPoint.position.end());
+        }
+
+        computeBounds(lineData.positions.data(), 3, lineData.positions.size() / 3, lineData.bounds, lineData.boundingSphere);
+        computeBounds(pointData.positions.data(), 3, pointData.positions.size() / 3, pointData.bounds, pointData.boundingSphere);
+
+        if (triData.getVertexCount() > 0 && triData.getIndexCount() > 0) {
             TriGeometryInfo newTriInfo = {
                 .id = static_cast<Standard_UInteger>(triGeometryMap.size()),
-                .geometry = std::move(triData)
+                .geometry = std::move(triData),
+                .lodGeometries = std::move(triangulation.lodTriData)
             };
             const auto [triIt, triInserted] = triGeometryMap.emplace(shape.TShape().get(), std::move(newTriInfo));
             triGeometryIndex = static_cast<Standard_Integer>(triIt->second.id);
+            triGeometryShapes.push_back(shape);
         }
 
         if (!lineData.positions.empty()) {
@@ -412,7 +1202,165 @@ private:
         return processedInfo;
     }
 
-    void resolveShapeTree(const TopoDS_Shape& rootShape) {
+    // column-major 4x4 matrix
+    static std::array<float, 16> toMatrixArray(const gp_Trsf& transform) {
+        std::array<float, 16> matrixArray;
+        for (Standard_Integer row = 1; row < 4; ++row) {
+            for (Standard_Integer col = 1; col <= 4; ++col) {
+                matrixArray[(col - 1) * 4 + (row - 1)] = static_cast<float>(transform.Value(row, col));
+            }
+        }
+        matrixArray[3] = 0.0f;
+        matrixArray[7] = 0.0f;
+        matrixArray[11] = 0.0f;
+        matrixArray[15] = 1.0f;
+        return matrixArray;
+    }
+
+    static void expandBounds(Bounds& bounds, const Bounds& other) {
+        for (size_t axis = 0; axis < 3; ++axis) {
+            bounds[axis] = std::min(bounds[axis], other[axis]);
+            bounds[axis + 3] = std::max(bounds[axis + 3], other[axis + 3]);
+        }
+    }
+
+    // bounds of the transformed box corners
+    static Bounds transformBounds(const Bounds& bounds, const gp_Trsf& transform) {
+        Bounds result = EMPTY_BOUNDS;
+        if (bounds[0] > bounds[3]) {
+            return result;
+        }
+        for (int corner = 0; corner < 8; ++corner) {
+            gp_Pnt pnt(
+                bounds[(corner & 1) ? 3 : 0],
+                bounds[(corner & 2) ? 4 : 1],
+                bounds[(corner & 4) ? 5 : 2]
+            );
+            pnt.Transform(transform);
+            const Bounds pointBounds = {
+                static_cast<float>(pnt.X()), static_cast<float>(pnt.Y()), static_cast<float>(pnt.Z()),
+                static_cast<float>(pnt.X()), static_cast<float>(pnt.Y()), static_cast<float>(pnt.Z())
+            };
+            expandBounds(result, pointBounds);
+        }
+        return result;
+    }
+
+    // copies every mesh tri geometry into the batch of the mesh material, transformed to world space.
+    // batches follow the material order, meshes without material come last.
+    static std::vector<MaterialBatch> buildMaterialBatches(const std::vector<TriGeometry>& tris, const std::vector<Mesh>& meshes, size_t materialCount) {
+        std::vector<MaterialBatch> batches(materialCount + 1);
+        for (size_t i = 0; i < materialCount; ++i) {
+            batches[i].materialIndex = static_cast<int>(i);
+        }
+
+        for (size_t meshIndex = 0; meshIndex < meshes.size(); ++meshIndex) {
+            const Mesh& mesh = meshes[meshIndex];
+            if (mesh.getTriGeometryIndex() < 0) {
+                continue;
+            }
+            const TriGeometry& geometry = tris[static_cast<size_t>(mesh.getTriGeometryIndex())];
+            MaterialBatch& batch = batches[mesh.getMaterialIndex() >= 0 ? static_cast<size_t>(mesh.getMaterialIndex()) : materialCount];
+
+            // normals use the cofactor matrix, the inverse transpose up to a scale
+            const std::array<float, 16>& m = mesh.getWorldTransformData();
+            const std::array<float, 9> cofactor = {
+                m[5] * m[10] - m[9] * m[6], m[9] * m[2] - m[1] * m[10], m[1] * m[6] - m[5] * m[2],
+                m[8] * m[6] - m[4] * m[10], m[0] * m[10] - m[8] * m[2], m[4] * m[2] - m[0] * m[6],
+                m[4] * m[9] - m[8] * m[5], m[8] * m[1] - m[0] * m[9], m[0] * m[5] - m[4] * m[1]
+            };
+            const float determinant = m[0] * cofactor[0] + m[4] * cofactor[1] + m[8] * cofactor[2];
+            const float normalSign = determinant < 0.0f ? -1.0f : 1.0f;
+
+            const size_t vertexCount = geometry.getVertexCount();
+            const size_t indexCount = geometry.getIndexCount();
+            const uint32_t firstVertex = static_cast<uint32_t>(batch.positions.size() / 3);
+            const uint32_t firstIndex = static_cast<uint32_t>(batch.indices.size());
+            batch.positions.reserve(batch.positions.size() + vertexCount * 3);
+            batch.normals.reserve(batch.normals.size() + vertexCount * 3);
+            batch.uvs.reserve(batch.uvs.size() + vertexCount * 2);
+            for (size_t vertex = 0; vertex < vertexCount; ++vertex) {
+                const std::array<float, 3> p = geometry.getVertexPosition(vertex);
+                batch.positions.push_back(m[0] * p[0] + m[4] * p[1] + m[8] * p[2] + m[12]);
+                batch.positions.push_back(m[1] * p[0] + m[5] * p[1] + m[9] * p[2] + m[13]);
+                batch.positions.push_back(m[2] * p[0] + m[6] * p[1] + m[10] * p[2] + m[14]);
+
+                const std::array<float, 3> n = geometry.getVertexNormal(vertex);
+                std::array<float, 3> normal;
+                for (size_t row = 0; row < 3; ++row) {
+                    normal[row] = cofactor[row * 3] * n[0] + cofactor[row * 3 + 1] * n[1] + cofactor[row * 3 + 2] * n[2];
+                }
+                const float length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+                const float normalScale = length > 0.0f ? normalSign / length : 0.0f;
+                for (size_t axis = 0; axis < 3; ++axis) {
+                    batch.normals.push_back(normal[axis] * normalScale);
+                }
+
+                const std::array<float, 2> uv = geometry.getVertexUV(vertex);
+                batch.uvs.push_back(uv[0]);
+                batch.uvs.push_back(uv[1]);
+            }
+
+            // mirroring transforms flip the winding back to counterclockwise
+            batch.indices.reserve(batch.indices.size() + indexCount);
+            for (size_t i = 0; i + 2 < indexCount; i += 3) {
+                const uint32_t a = firstVertex + geometry.indexAt(i);
+                const uint32_t b = firstVertex + geometry.indexAt(i + 1);
+                const uint32_t c = firstVertex + geometry.indexAt(i + 2);
+                batch.indices.push_back(a);
+                batch.indices.push_back(determinant < 0.0f ? c : b);
+                batch.indices.push_back(determinant < 0.0f ? b : c);
+            }
+
+            batch.meshRanges.insert(batch.meshRanges.end(), {
+                static_cast<uint32_t>(meshIndex),
+                firstIndex,
+                static_cast<uint32_t>(indexCount),
+                firstVertex,
+                static_cast<uint32_t>(vertexCount)
+            });
+        }
+
+        batches.erase(
+            std::remove_if(batches.begin(), batches.end(), [](const MaterialBatch& batch) { return batch.meshRanges.empty(); }),
+            batches.end());
+        for (MaterialBatch& batch : batches) {
+            batch.positions.shrink_to_fit();
+            batch.normals.shrink_to_fit();
+            batch.uvs.shrink_to_fit();
+            batch.indices.shrink_to_fit();
+        }
+        return batches;
+    }
+
+    // box around the positions and a sphere around the box center
+    static void computeBounds(const float* positions, size_t stride, size_t vertexCount, Bounds& bounds, BoundingSphere& boundingSphere) {
+        bounds = EMPTY_BOUNDS;
+        boundingSphere = EMPTY_BOUNDING_SPHERE;
+        if (vertexCount == 0) {
+            return;
+        }
+        for (size_t i = 0; i < vertexCount; ++i) {
+            for (size_t axis = 0; axis < 3; ++axis) {
+                bounds[axis] = std::min(bounds[axis], positions[i * stride + axis]);
+                bounds[axis + 3] = std::max(bounds[axis + 3], positions[i * stride + axis]);
+            }
+        }
+        float radiusSquared = 0.0f;
+        for (size_t axis = 0; axis < 3; ++axis) {
+            boundingSphere[axis] = (bounds[axis] + bounds[axis + 3]) * 0.5f;
+        }
+        for (size_t i = 0; i < vertexCount; ++i) {
+            const float dx = positions[i * stride] - boundingSphere[0];
+            const float dy = positions[i * stride + 1] - boundingSphere[1];
+            const float dz = positions[i * stride + 2] - boundingSphere[2];
+            radiusSquared = std::max(radiusSquared, dx * dx + dy * dy + dz * dz);
+        }
+        boundingSphere[3] = std::sqrt(radiusSquared);
+    }
+
+    // returns false when cancelled
+    bool resolveShapeTree(const TopoDS_Shape& rootShape, Message_ProgressScope& progressScope) {
         struct StackFrame {
             TopoDS_Shape shape;
             Standard_Integer parentMeshIndex;
@@ -422,6 +1370,10 @@ private:
         stack.push_back({ rootShape, -1, gp_Trsf() });
 
         while (!stack.empty()) {
+            if (!progressScope.More()) {
+                return false;
+            }
+
             auto [shape, parentMeshIndex, parentWorldTransform] = stack.back();
             stack.pop_back();
 
@@ -429,16 +1381,7 @@ private:
             gp_Trsf shapeTransform = shape.Location().Transformation();
             
             gp_Trsf relativeTransform = parentWorldTransform.Inverted().Multiplied(shapeTransform);
-            std::array<float, 16> matrixArray;
-            for (Standard_Integer row = 1; row < 4; ++row) {
-                for (Standard_Integer col = 1; col <= 4; ++col) {
-                    matrixArray[(col - 1) * 4 + (row - 1)] = static_cast<float>(relativeTransform.Value(row, col));
-                }
-            }
-            matrixArray[3] = 0.0f;
-            matrixArray[7] = 0.0f;
-            matrixArray[11] = 0.0f;
-            matrixArray[15] = 1.0f;
+            std::array<float, 16> matrixArray = toMatrixArray(relativeTransform);
 
             MeshShapeType shapeType;
             switch (shape.ShapeType()) {
@@ -483,15 +1426,46 @@ private:
                     stack.push_back({ it.Value(), meshIndex, shapeTransform });
                 }
             } else if (shape.ShapeType() == TopAbs_SOLID || shape.ShapeType() == TopAbs_SHELL) {
-                ProcessedShapeInfo processedInfo = triangulateShape(shape);
+                const auto processedIt = processedShapeMap.find(shape.TShape().get());
+                ProcessedShapeInfo processedInfo;
+                if (processedIt != processedShapeMap.end()) {
+                    processedInfo = processedIt->second;
+                } else {
+                    const auto prebuiltIt = prebuiltShapeMap.find(shape.TShape().get());
+                    if (prebuiltIt != prebuiltShapeMap.end()) {
+                        processedInfo = registerShapeTriangulation(shape, std::move(prebuiltIt->second));
+                        prebuiltShapeMap.erase(prebuiltIt);
+                    } else {
+                        ShapeTriangulation triangulation = buildShapeTriangulation(shape, progressScope.Next(), Standard_True);
+                        if (!triangulation.completed) {
+                            return false;
+                        }
+                        processedInfo = registerShapeTriangulation(shape, std::move(triangulation));
+                        progress->addItems(1);
+                    }
+                }
                 triGeometryIndex = processedInfo.triGeometryIndex;
                 lineGeometryIndex = processedInfo.lineGeometryIndex;
                 pointGeometryIndex = processedInfo.pointGeometryIndex;
             }
 
+            // geometries are in the shape space, children are added once the traversal is done
+            Bounds worldBounds = EMPTY_BOUNDS;
+            if (triGeometryIndex >= 0) {
+                expandBounds(worldBounds, transformBounds(triGeometryMap.at(shape.TShape().get()).geometry.bounds, shapeTransform));
+            }
+            if (lineGeometryIndex >= 0) {
+                expandBounds(worldBounds, transformBounds(lineGeometryMap.at(shape.TShape().get()).geometry.bounds, shapeTransform));
+            }
+            if (pointGeometryIndex >= 0) {
+                expandBounds(worldBounds, transformBounds(pointGeometryMap.at(shape.TShape().get()).geometry.bounds, shapeTransform));
+            }
+
             meshes.push_back(Mesh(
                 std::move(shapeName),
                 matrixArray,
+                toMatrixArray(shapeTransform),
+                worldBounds,
                 shapeType,
                 triGeometryIndex,
                 lineGeometryIndex,
@@ -500,13 +1474,41 @@ private:
                 parentMeshIndex
             ));
         }
+        return true;
     }
 };
 
-TriangulatedModel ModelTriangulationImpl::computeTriangulation(
+std::optional<TriangulatedModel> ModelTriangulationImpl::computeTriangulation(
     Handle(XCAFDoc_ShapeTool)& shapeTool,
-    Handle(XCAFDoc_ColorTool)& colorTool
+    Handle(XCAFDoc_ColorTool)& colorTool,
+    const TriangulationOptions& options,
+    const Handle(TaskProgress)& progress,
+    std::vector<TopoDS_Shape>* triGeometryShapes,
+    TriangulationCache* cache
+) {
+    if (!options.isValid()) {
+        std::cerr << "Triangulation error: invalid options" << std::endl;
+        return std::nullopt;
+    }
+    TriangulationContext context(shapeTool, colorTool, options, progress, cache);
+    std::optional<TriangulatedModel> model = context.compute();
+    if (triGeometryShapes != nullptr) {
+        *triGeometryShapes = std::move(context.getTriGeometryShapes());
+    }
+    return model;
+}
+
+bool ModelTriangulationImpl::refineTriangulation(
+    const std::vector<TopoDS_Shape>& triGeometryShapes,
+    const TriangulationOptions& options,
+    const Handle(TaskProgress)& progress,
+    const std::function<void(size_t, TriGeometry&&)>& onGeometry,
+    TriangulationCache* cache
 ) {
-    TriangulationContext context(shapeTool, colorTool);
-    return context.compute();
+    if (!options.isValid()) {
+        std::cerr << "Triangulation error: invalid options" << std::endl;
+        return false;
+    }
+    TriangulationContext context(nullptr, nullptr, options, progress, cache);
+    return context.refine(triGeometryShapes, onGeometry);
 }
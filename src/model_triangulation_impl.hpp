@@ -7,17 +7,44 @@
 
 #pragma once
 
+#include <functional>
+#include <optional>
 #include <string>
+#include <vector>
 
 #include <XCAFDoc_ShapeTool.hxx>
 #include <XCAFDoc_ColorTool.hxx>
+#include <TopoDS_Shape.hxx>
 
 #include "model_context.hpp"
+#include "task_progress.hpp"
+
+class TriangulationCache;
 
 class ModelTriangulationImpl {
 public:
-    static TriangulatedModel computeTriangulation(
+    // returns std::nullopt when cancelled through the progress indicator, or for invalid options.
+    // with options.parallel set, unique solids and shells are meshed concurrently (multithreaded builds only).
+    // triGeometryShapes receives the shape of each tri geometry, to refine the model later.
+    // solids and shells found in the cache are not meshed, the other ones are stored into it.
+    static std::optional<TriangulatedModel> computeTriangulation(
         Handle(XCAFDoc_ShapeTool)& shapeTool,
-        Handle(XCAFDoc_ColorTool)& colorTool
+        Handle(XCAFDoc_ColorTool)& colorTool,
+        const TriangulationOptions& options,
+        const Handle(TaskProgress)& progress,
+        std::vector<TopoDS_Shape>* triGeometryShapes = nullptr,
+        TriangulationCache* cache = nullptr
+    );
+
+    // remeshes the tri geometries of a computed model with other options, calling onGeometry with
+    // the geometry index and the new geometry (concurrently in multithreaded builds).
+    // line and point geometries and levels of detail are not refined. returns false when cancelled
+    // or for invalid options.
+    static bool refineTriangulation(
+        const std::vector<TopoDS_Shape>& triGeometryShapes,
+        const TriangulationOptions& options,
+        const Handle(TaskProgress)& progress,
+        const std::function<void(size_t, TriGeometry&&)>& onGeometry,
+        TriangulationCache* cache = nullptr
     );
 };
@@ -0,0 +1,19 @@
+// Copyright (c) 2025 SolverX Corporation
+// This file is part of MIE OpenCascade WebAssembly Bindings.
+//
+// This library is free software; you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License version 2.1 as published
+// by the Free Software Foundation.
+
+#include "task_progress.hpp"
+
+#include <emscripten/bind.h>
+
+EMSCRIPTEN_BINDINGS(task_progress_module) {
+    emscripten::enum_<TaskPhase>("TaskPhase")
+        .value("Pending", TaskPhase::Pending)
+        .value("Reading", TaskPhase::Reading)
+        .value("Transferring", TaskPhase::Transferring)
+        .value("Triangulating", TaskPhase::Triangulating)
+        .value("Completed", TaskPhase::Completed);
+}
@@ -0,0 +1,95 @@
+// Copyright (c) 2025 SolverX Corporation
+// This file is part of MIE OpenCascade WebAssembly Bindings.
+//
+// This library is free software; you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License version 2.1 as published
+// by the Free Software Foundation.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include <Message_ProgressIndicator.hxx>
+#include <Message_ProgressScope.hxx>
+
+enum class TaskPhase {
+    Pending,
+    Reading, // items are bytes
+    Transferring,
+    Triangulating, // items are unique shapes
+    Completed
+};
+
+// progress indicator shared between a task and the OCCT algorithms it runs.
+// cancellation is polled by OCCT through UserBreak(), and by our own loops through isCancelled().
+// all state is atomic so that JS can poll it every frame without taking the task mutex.
+class TaskProgress : public Message_ProgressIndicator {
+    DEFINE_STANDARD_RTTI_INLINE(TaskProgress, Message_ProgressIndicator)
+
+private:
+    std::atomic<bool> cancelled;
+    std::atomic<TaskPhase> phase;
+    std::atomic<float> fraction; // of the current phase
+    std::atomic<uint32_t> itemsProcessed;
+    std::atomic<uint32_t> itemsTotal; // 0 if unknown
+
+public:
+    TaskProgress()
+        : cancelled(false)
+        , phase(TaskPhase::Pending)
+        , fraction(0.0f)
+        , itemsProcessed(0)
+        , itemsTotal(0)
+    {
+    }
+
+    void cancel() {
+        cancelled.store(true, std::memory_order_relaxed);
+    }
+
+    bool isCancelled() const {
+        return cancelled.load(std::memory_order_relaxed);
+    }
+
+    // resets the counters; phases driven by OCCT algorithms call Start() afterwards
+    void setPhase(TaskPhase newPhase, uint32_t newItemsTotal = 0) {
+        fraction.store(newPhase == TaskPhase::Completed ? 1.0f : 0.0f, std::memory_order_relaxed);
+        itemsProcessed.store(0, std::memory_order_relaxed);
+        itemsTotal.store(newItemsTotal, std::memory_order_relaxed);
+        phase.store(newPhase, std::memory_order_relaxed);
+    }
+
+    void addItems(uint32_t count) {
+        itemsProcessed.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    // for phases without an OCCT progress scope
+    void setFraction(float value) {
+        fraction.store(value, std::memory_order_relaxed);
+    }
+
+    TaskPhase getPhase() const {
+        return phase.load(std::memory_order_relaxed);
+    }
+
+    float getFraction() const {
+        return fraction.load(std::memory_order_relaxed);
+    }
+
+    uint32_t getItemsProcessed() const {
+        return itemsProcessed.load(std::memory_order_relaxed);
+    }
+
+    uint32_t getItemsTotal() const {
+        return itemsTotal.load(std::memory_order_relaxed);
+    }
+
+    Standard_Boolean UserBreak() override {
+        return isCancelled();
+    }
+
+    void Show(const Message_ProgressScope&, const Standard_Boolean) override {
+        fraction.store(static_cast<float>(GetPosition()), std::memory_order_relaxed);
+    }
+};
@@ -0,0 +1,123 @@
+// Copyright (c) 2025 SolverX Corporation
+// This file is part of MIE OpenCascade WebAssembly Bindings.
+//
+// This library is free software; you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License version 2.1 as published
+// by the Free Software Foundation.
+
+#include "task_scheduler.hpp"
+
+#ifdef __EMSCRIPTEN_PTHREADS__
+#include <emscripten/bind.h>
+
+#include <algorithm>
+#include <utility>
+
+TaskScheduler::TaskScheduler(size_t workerCount)
+    : workerCount(workerCount)
+    , idleWorkerCount(0)
+    , nextSequence(0)
+    , stopping(false)
+{
+}
+
+TaskScheduler::~TaskScheduler() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    taskAvailable.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+TaskScheduler& TaskScheduler::instance() {
+    // half of the cores, the other half is left to the OCCT thread pool used inside BRepMesh
+    static TaskScheduler scheduler(std::max<size_t>(1, std::thread::hardware_concurrency() / 2));
+    return scheduler;
+}
+
+void TaskScheduler::submit(std::function<void()> job, TaskPriority priority) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queue.push({ priority, nextSequence++, std::move(job) });
+
+        // workers are started lazily so that loading the module does not occupy pthreads
+        if (idleWorkerCount < queue.size() && workers.size() < workerCount) {
+            workers.emplace_back(&TaskScheduler::workerLoop, this);
+        }
+    }
+    taskAvailable.notify_one();
+}
+
+void TaskScheduler::parallelFor(size_t count, const std::function<void(size_t)>& body, TaskPriority priority) {
+    struct SharedState {
+        std::atomic<size_t> next;
+        size_t count;
+        const std::function<void(size_t)>* body; // only dereferenced while items are left
+        std::mutex mutex;
+        std::condition_variable finished;
+        size_t completedCount;
+    };
+    auto state = std::make_shared<SharedState>();
+    state->next = 0;
+    state->count = count;
+    state->body = &body;
+    state->completedCount = 0;
+
+    auto run = [](SharedState& state) {
+        size_t localCount = 0;
+        for (size_t i = state.next.fetch_add(1); i < state.count; i = state.next.fetch_add(1)) {
+            (*state.body)(i);
+            ++localCount;
+        }
+        if (localCount > 0) {
+            std::lock_guard<std::mutex> lock(state.mutex);
+            state.completedCount += localCount;
+            if (state.completedCount == state.count) {
+                state.finished.notify_all();
+            }
+        }
+    };
+
+    // helpers which start late find nothing left and return immediately
+    const size_t helperCount = std::min(workerCount, count > 0 ? count - 1 : 0);
+    for (size_t i = 0; i < helperCount; ++i) {
+        submit([state, run]() { run(*state); }, priority);
+    }
+    run(*state);
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->finished.wait(lock, [&state]() { return state->completedCount == state->count; });
+}
+
+size_t TaskScheduler::getWorkerCount() const {
+    return workerCount;
+}
+
+void TaskScheduler::workerLoop() {
+    while (true) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            ++idleWorkerCount;
+            taskAvailable.wait(lock, [this]() { return stopping || !queue.empty(); });
+            --idleWorkerCount;
+            if (stopping && queue.empty()) {
+                return;
+            }
+            job = std::move(const_cast<QueuedTask&>(queue.top()).job);
+            queue.pop();
+        }
+        job();
+    }
+}
+
+EMSCRIPTEN_BINDINGS(task_scheduler_module) {
+    emscripten::enum_<TaskPriority>("TaskPriority")
+        .value("Low", TaskPriority::Low)
+        .value("Normal", TaskPriority::Normal)
+        .value("High", TaskPriority::High);
+}
+#endif
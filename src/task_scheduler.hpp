@@ -0,0 +1,71 @@
+// Copyright (c) 2025 SolverX Corporation
+// This file is part of MIE OpenCascade WebAssembly Bindings.
+//
+// This library is free software; you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License version 2.1 as published
+// by the Free Software Foundation.
+
+#pragma once
+
+#ifdef __EMSCRIPTEN_PTHREADS__
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+enum class TaskPriority {
+    Low,
+    Normal,
+    High
+};
+
+// fixed-size worker pool shared by all async entry points, so that in-flight requests
+// queue up instead of each taking another worker out of the emscripten pthread pool
+class TaskScheduler {
+private:
+    struct QueuedTask {
+        TaskPriority priority;
+        uint64_t sequence; // FIFO order within the same priority
+        std::function<void()> job;
+    };
+    struct QueuedTaskOrder {
+        bool operator()(const QueuedTask& a, const QueuedTask& b) const {
+            if (a.priority != b.priority) {
+                return a.priority < b.priority;
+            }
+            return a.sequence > b.sequence;
+        }
+    };
+
+    std::mutex mutex;
+    std::condition_variable taskAvailable;
+    std::priority_queue<QueuedTask, std::vector<QueuedTask>, QueuedTaskOrder> queue;
+    std::vector<std::thread> workers;
+    size_t workerCount;
+    size_t idleWorkerCount;
+    uint64_t nextSequence;
+    bool stopping;
+
+    explicit TaskScheduler(size_t workerCount);
+    void workerLoop();
+
+public:
+    ~TaskScheduler();
+
+    TaskScheduler(const TaskScheduler&) = delete;
+    TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+    static TaskScheduler& instance();
+
+    void submit(std::function<void()> job, TaskPriority priority = TaskPriority::Normal);
+    // runs body(0..count-1) on the workers and the calling thread, and returns once all are done.
+    // the caller takes part, so this is safe to call from a task which is itself on a worker.
+    void parallelFor(size_t count, const std::function<void(size_t)>& body, TaskPriority priority = TaskPriority::High);
+    size_t getWorkerCount() const;
+};
+#endif
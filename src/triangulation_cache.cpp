@@ -0,0 +1,99 @@
+// Copyright (c) 2025 SolverX Corporation
+// This file is part of MIE OpenCascade WebAssembly Bindings.
+//
+// This library is free software; you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License version 2.1 as published
+// by the Free Software Foundation.
+
+#include "triangulation_cache.hpp"
+#ifdef __EMSCRIPTEN_PTHREADS__
+#include "async_task.hpp"
+
+#include <emscripten/proxying.h>
+#include <emscripten/threading.h>
+#endif
+
+#include <functional>
+
+namespace {
+
+// JS objects only live on the main runtime thread, while shapes are meshed on workers
+void callOnMainRuntimeThread(const std::function<void()>& job) {
+#ifdef __EMSCRIPTEN_PTHREADS__
+    runOnMainRuntimeThreadSync(job);
+#else
+    job();
+#endif
+}
+
+// anything but a Uint8Array is a miss
+std::optional<std::vector<uint8_t>> toEntry(const emscripten::val& data) {
+    if (!data.instanceof(emscripten::val::global("Uint8Array"))) {
+        return std::nullopt;
+    }
+    return emscripten::convertJSArrayToNumberVector<uint8_t>(data);
+}
+
+#ifdef __EMSCRIPTEN_PTHREADS__
+// a load proxied to the main runtime thread, on the stack of the worker waiting for it
+struct PendingLoad {
+    TriangulationCache* cache;
+    const std::string* key;
+    bool waitForPromise;
+    em_proxying_ctx* context = nullptr;
+    std::optional<std::vector<uint8_t>> entry;
+};
+#endif
+
+} // namespace
+
+std::optional<std::vector<uint8_t>> TriangulationCache::load(const std::string& key, bool waitForPromise) {
+#ifdef __EMSCRIPTEN_PTHREADS__
+    if (!emscripten_is_main_runtime_thread()) {
+        // the worker stays blocked until the proxied call finishes, which waits for a promise returned by get
+        PendingLoad load { this, &key, waitForPromise };
+        emscripten_proxy_sync_with_ctx(emscripten_proxy_get_system_queue(), emscripten_main_runtime_thread_id(), [](em_proxying_ctx* context, void* arg) {
+            PendingLoad& load = *static_cast<PendingLoad*>(arg);
+            emscripten::val data = load.cache->get(*load.key);
+            if (!load.waitForPromise || !data.instanceof(emscripten::val::global("Promise"))) {
+                load.entry = toEntry(data);
+                emscripten_proxy_finish(context);
+                return;
+            }
+            // a rejection settles with its reason, which is a miss
+            load.context = context;
+            emscripten::val settle = emscripten::val::module_property("TriangulationCache")["settleLoad"]
+                .call<emscripten::val>("bind", emscripten::val::null(), reinterpret_cast<uintptr_t>(&load));
+            data.call<void>("then", settle, settle);
+        }, &load);
+        return std::move(load.entry);
+    }
+#endif
+    // the main runtime thread can not wait, a promise is a miss there
+    (void)waitForPromise;
+    return toEntry(get(key));
+}
+
+#ifdef __EMSCRIPTEN_PTHREADS__
+void TriangulationCache::settleLoad(uintptr_t pendingLoad, const emscripten::val& data) {
+    PendingLoad& load = *reinterpret_cast<PendingLoad*>(pendingLoad);
+    load.entry = toEntry(data);
+    emscripten_proxy_finish(load.context);
+}
+#endif
+
+void TriangulationCache::store(const std::string& key, const ByteBuffer& data) {
+    callOnMainRuntimeThread([&]() {
+        put(key, data.getView());
+    });
+}
+
+EMSCRIPTEN_BINDINGS(triangulation_cache_module) {
+    emscripten::class_<TriangulationCache>("TriangulationCache")
+        .function("get", &TriangulationCache::get, emscripten::pure_virtual())
+        .function("put", &TriangulationCache::put, emscripten::pure_virtual())
+#ifdef __EMSCRIPTEN_PTHREADS__
+        .class_function("settleLoad", &TriangulationCache::settleLoad)
+#endif
+        .allow_subclass<TriangulationCacheWrapper>("TriangulationCacheWrapper");
+}
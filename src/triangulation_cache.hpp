@@ -0,0 +1,55 @@
+// Copyright (c) 2025 SolverX Corporation
+// This file is part of MIE OpenCascade WebAssembly Bindings.
+//
+// This library is free software; you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License version 2.1 as published
+// by the Free Software Foundation.
+
+#pragma once
+
+#include <emscripten/bind.h>
+#include <emscripten/val.h>
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "common.hpp"
+
+// storage for triangulated solids and shells, implemented in JS with TriangulationCache.implement({ get, put }).
+// keys combine the shape content hash and the triangulation parameters, so a hit skips meshing the shape.
+// entries are opaque bytes, which are rejected and remeshed when they come from another format version.
+class TriangulationCache {
+public:
+    virtual ~TriangulationCache() = default;
+
+    // the Uint8Array stored under key, or undefined, or a promise of either, e.g. from IndexedDB.
+    // asynchronous triangulations wait until the promise settles. synchronous ones block the main runtime
+    // thread, where the promise would never settle, so they take a promise as a miss.
+    virtual emscripten::val get(const std::string& key) = 0;
+    // data views the wasm memory and is only valid during the call, copy it to keep it
+    virtual void put(const std::string& key, const Uint8Array& data) = 0;
+
+    // for the triangulation, from any thread. the JS methods are called on the main runtime thread.
+    // waitForPromise is false while the main runtime thread is blocked on the triangulation.
+    std::optional<std::vector<uint8_t>> load(const std::string& key, bool waitForPromise);
+    void store(const std::string& key, const ByteBuffer& data);
+#ifdef __EMSCRIPTEN_PTHREADS__
+    // completes a load waiting for the promise returned by get, bound as its callbacks
+    static void settleLoad(uintptr_t pendingLoad, const emscripten::val& data);
+#endif
+};
+
+class TriangulationCacheWrapper : public emscripten::wrapper<TriangulationCache> {
+public:
+    EMSCRIPTEN_WRAPPER(TriangulationCacheWrapper);
+
+    emscripten::val get(const std::string& key) override {
+        return call<emscripten::val>("get", key);
+    }
+
+    void put(const std::string& key, const Uint8Array& data) override {
+        call<void>("put", key, data);
+    }
+};